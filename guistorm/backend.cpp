@@ -0,0 +1,9 @@
+#include "backend.h"
+
+namespace guistorm {
+
+backend::~backend() {
+  /// Default destructor
+}
+
+}
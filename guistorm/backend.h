@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <GL/glew.h>
+
+namespace guistorm {
+
+class backend {
+  /// Abstract interface to the graphics api - every call guistorm makes to the
+  /// gpu goes through one of these, so the library can be run against
+  /// something other than a live OpenGL context, such as backend_null.
+  /// The calls mirror the OpenGL functions they replace one to one.
+public:
+  virtual ~backend();
+
+  // context
+  virtual bool has_context() = 0;
+  virtual GLint get_max_texture_size() = 0;
+  virtual bool has_instancing() = 0;
+  virtual bool has_vertex_arrays() = 0;
+  virtual bool has_framebuffers() = 0;
+
+  // state
+  virtual void enable( GLenum capability) = 0;
+  virtual void disable(GLenum capability) = 0;
+  virtual void blend_func(GLenum source, GLenum destination) = 0;
+  virtual void blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) = 0;
+  virtual void viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+  virtual void scissor( GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+  virtual void get_integerv(GLenum name, GLint *values) = 0;
+
+  // shaders
+  virtual GLuint load_program(std::string const &vertex, std::string const &fragment) = 0;
+  virtual void delete_program(GLuint program) = 0;
+  virtual void use_program(GLuint program) = 0;
+  virtual GLint get_attrib_location( GLuint program, char const *name) = 0;
+  virtual GLint get_uniform_location(GLuint program, char const *name) = 0;
+  virtual void uniform1f(GLint location, GLfloat x) = 0;
+  virtual void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) = 0;
+
+  // buffers
+  virtual GLuint gen_buffer() = 0;
+  virtual void delete_buffer(GLuint buffer) = 0;
+  virtual void bind_buffer(GLenum target, GLuint buffer) = 0;
+  virtual void buffer_data(GLenum target, GLsizeiptr size, void const *data, GLenum usage) = 0;
+
+  // vertex array objects
+  virtual GLuint gen_vertex_array() = 0;
+  virtual void delete_vertex_array(GLuint vertex_array) = 0;
+  virtual void bind_vertex_array(GLuint vertex_array) = 0;
+
+  // vertex attributes
+  virtual void enable_vertex_attrib_array( GLuint index) = 0;
+  virtual void disable_vertex_attrib_array(GLuint index) = 0;
+  virtual void vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) = 0;
+  virtual void vertex_attrib_divisor(GLuint index, GLuint divisor) = 0;
+  virtual void vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) = 0;
+
+  // textures
+  virtual GLuint gen_texture() = 0;
+  virtual void delete_texture(GLuint texture) = 0;
+  virtual void bind_texture(GLenum target, GLuint texture) = 0;
+  virtual void tex_parameter(GLenum target, GLenum name, GLint value) = 0;
+  virtual void tex_image_2d(    GLenum target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) = 0;
+  virtual void tex_sub_image_2d(GLenum target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) = 0;
+
+  // framebuffers
+  virtual GLuint gen_framebuffer() = 0;
+  virtual void delete_framebuffer(GLuint framebuffer) = 0;
+  virtual void bind_framebuffer(GLenum target, GLuint framebuffer) = 0;
+  virtual void framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture) = 0;
+  virtual GLenum check_framebuffer_status(GLenum target) = 0;
+
+  // drawing
+  virtual void clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) = 0;
+  virtual void draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) = 0;
+  virtual void draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) = 0;
+};
+
+}
@@ -0,0 +1,362 @@
+#include "backend_cache.h"
+
+namespace guistorm {
+
+bool backend_cache::attrib_pointer::operator==(attrib_pointer const &other) const {
+  /// Compare every parameter of the pointer, including the buffer it points into
+  return buffer     == other.buffer &&
+         size       == other.size &&
+         type       == other.type &&
+         normalised == other.normalised &&
+         stride     == other.stride &&
+         offset     == other.offset;
+}
+
+backend_cache::backend_cache(backend &new_target)
+  : target(&new_target) {
+  /// Specific constructor
+}
+
+backend_cache::~backend_cache() {
+  /// Default destructor
+}
+
+void backend_cache::set_target(backend &new_target) {
+  /// Pass calls on to a different backend, forgetting everything we knew about the old one
+  target = &new_target;
+  invalidate();
+}
+backend &backend_cache::get_target() {
+  /// Return the backend calls are passed on to
+  return *target;
+}
+void backend_cache::invalidate() {
+  /// Forget all known state, for instance because someone else may have changed it since
+  capabilities.clear();
+  program.reset();
+  uniforms.clear();
+  buffers.clear();
+  vertex_array.reset();
+  attribs.clear();
+  attrib_constants.clear();
+  textures.clear();
+}
+unsigned int backend_cache::take_skipped() {
+  /// Return how many calls have been dropped since this was last called, and start counting again
+  unsigned int const result = skipped;
+  skipped = 0;
+  return result;
+}
+
+bool backend_cache::has_context() {
+  /// Pass through to the target
+  return target->has_context();
+}
+GLint backend_cache::get_max_texture_size() {
+  /// Pass through to the target
+  return target->get_max_texture_size();
+}
+bool backend_cache::has_instancing() {
+  /// Pass through to the target
+  return target->has_instancing();
+}
+bool backend_cache::has_vertex_arrays() {
+  /// Pass through to the target
+  return target->has_vertex_arrays();
+}
+bool backend_cache::has_framebuffers() {
+  /// Pass through to the target
+  return target->has_framebuffers();
+}
+
+void backend_cache::enable(GLenum capability) {
+  /// Enable a capability unless it's already known to be enabled
+  auto const it = capabilities.find(capability);
+  if(it != capabilities.end() && it->second) {
+    ++skipped;
+    return;
+  }
+  target->enable(capability);
+  capabilities[capability] = true;
+}
+void backend_cache::disable(GLenum capability) {
+  /// Disable a capability unless it's already known to be disabled
+  auto const it = capabilities.find(capability);
+  if(it != capabilities.end() && !it->second) {
+    ++skipped;
+    return;
+  }
+  target->disable(capability);
+  capabilities[capability] = false;
+}
+
+void backend_cache::blend_func(GLenum source, GLenum destination) {
+  /// Pass through to the target
+  target->blend_func(source, destination);
+}
+void backend_cache::blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) {
+  /// Pass through to the target
+  target->blend_func_separate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+}
+void backend_cache::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Pass through to the target
+  target->viewport(x, y, width, height);
+}
+void backend_cache::scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Pass through to the target
+  target->scissor(x, y, width, height);
+}
+void backend_cache::get_integerv(GLenum name, GLint *values) {
+  /// Pass through to the target - queries are always answered by the real state, not what we remember
+  target->get_integerv(name, values);
+}
+
+GLuint backend_cache::load_program(std::string const &vertex, std::string const &fragment) {
+  /// Pass through to the target
+  return target->load_program(vertex, fragment);
+}
+void backend_cache::delete_program(GLuint this_program) {
+  /// Delete a program, forgetting it if it was current
+  if(program && *program == this_program) {
+    program.reset();
+    uniforms.clear();
+  }
+  target->delete_program(this_program);
+}
+void backend_cache::use_program(GLuint this_program) {
+  /// Switch program unless it's already current
+  if(program && *program == this_program) {
+    ++skipped;
+    return;
+  }
+  target->use_program(this_program);
+  program = this_program;
+  uniforms.clear();                                                             // uniforms belong to the program
+}
+GLint backend_cache::get_attrib_location(GLuint this_program, char const *name) {
+  /// Pass through to the target
+  return target->get_attrib_location(this_program, name);
+}
+GLint backend_cache::get_uniform_location(GLuint this_program, char const *name) {
+  /// Pass through to the target
+  return target->get_uniform_location(this_program, name);
+}
+void backend_cache::uniform1f(GLint location, GLfloat x) {
+  /// Set a uniform unless it's already known to hold this value
+  values const new_values{x, 0.0f, 0.0f, 0.0f};
+  auto const it = uniforms.find(location);
+  if(program && it != uniforms.end() && it->second == new_values) {
+    ++skipped;
+    return;
+  }
+  target->uniform1f(location, x);
+  if(program) {
+    uniforms[location] = new_values;
+  }
+}
+void backend_cache::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Set a uniform unless it's already known to hold these values
+  values const new_values{x, y, z, w};
+  auto const it = uniforms.find(location);
+  if(program && it != uniforms.end() && it->second == new_values) {
+    ++skipped;
+    return;
+  }
+  target->uniform4f(location, x, y, z, w);
+  if(program) {
+    uniforms[location] = new_values;
+  }
+}
+
+GLuint backend_cache::gen_buffer() {
+  /// Pass through to the target
+  return target->gen_buffer();
+}
+void backend_cache::delete_buffer(GLuint buffer) {
+  /// Delete a buffer, forgetting any bindings of it, which deleting resets to zero
+  for(auto &it : buffers) {
+    if(it.second == buffer) {
+      it.second = 0;
+    }
+  }
+  for(auto &it : attribs) {
+    if(it.second.pointer && it.second.pointer->buffer == buffer) {
+      it.second.pointer.reset();
+    }
+  }
+  target->delete_buffer(buffer);
+}
+void backend_cache::bind_buffer(GLenum buffer_target, GLuint buffer) {
+  /// Bind a buffer unless it's already known to be bound
+  auto const it = buffers.find(buffer_target);
+  if(it != buffers.end() && it->second == buffer) {
+    ++skipped;
+    return;
+  }
+  target->bind_buffer(buffer_target, buffer);
+  buffers[buffer_target] = buffer;
+}
+void backend_cache::buffer_data(GLenum buffer_target, GLsizeiptr size, void const *data, GLenum usage) {
+  /// Pass through to the target
+  target->buffer_data(buffer_target, size, data, usage);
+}
+
+GLuint backend_cache::gen_vertex_array() {
+  /// Pass through to the target
+  return target->gen_vertex_array();
+}
+void backend_cache::delete_vertex_array(GLuint this_vertex_array) {
+  /// Delete a vertex array object, which reverts to the default one if it was bound
+  if(vertex_array && *vertex_array == this_vertex_array) {
+    vertex_array = 0;
+    forget_vertex_array_state();
+  }
+  target->delete_vertex_array(this_vertex_array);
+}
+void backend_cache::bind_vertex_array(GLuint this_vertex_array) {
+  /// Bind a vertex array object unless it's already known to be bound
+  if(vertex_array && *vertex_array == this_vertex_array) {
+    ++skipped;
+    return;
+  }
+  target->bind_vertex_array(this_vertex_array);
+  vertex_array = this_vertex_array;
+  forget_vertex_array_state();                                                  // we know nothing about what it holds
+}
+
+void backend_cache::enable_vertex_attrib_array(GLuint index) {
+  /// Enable an attribute array unless it's already known to be enabled
+  attrib &this_attrib = attribs[index];
+  if(this_attrib.enabled && *this_attrib.enabled) {
+    ++skipped;
+    return;
+  }
+  target->enable_vertex_attrib_array(index);
+  this_attrib.enabled = true;
+}
+void backend_cache::disable_vertex_attrib_array(GLuint index) {
+  /// Disable an attribute array unless it's already known to be disabled
+  attrib &this_attrib = attribs[index];
+  if(this_attrib.enabled && !*this_attrib.enabled) {
+    ++skipped;
+    return;
+  }
+  target->disable_vertex_attrib_array(index);
+  this_attrib.enabled = false;
+}
+void backend_cache::vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) {
+  /// Point an attribute into the bound array buffer, unless it's already known to point there
+  auto const buffer = buffers.find(GL_ARRAY_BUFFER);
+  if(buffer == buffers.end()) {                                                 // we can't tell which buffer this would point into
+    target->vertex_attrib_pointer(index, size, type, normalised, stride, offset);
+    attribs[index].pointer.reset();
+    return;
+  }
+  attrib_pointer const new_pointer{buffer->second, size, type, normalised, stride, offset};
+  attrib &this_attrib = attribs[index];
+  if(this_attrib.pointer && *this_attrib.pointer == new_pointer) {
+    ++skipped;
+    return;
+  }
+  target->vertex_attrib_pointer(index, size, type, normalised, stride, offset);
+  this_attrib.pointer = new_pointer;
+}
+void backend_cache::vertex_attrib_divisor(GLuint index, GLuint divisor) {
+  /// Set an attribute's divisor unless it's already known to have it
+  attrib &this_attrib = attribs[index];
+  if(this_attrib.divisor && *this_attrib.divisor == divisor) {
+    ++skipped;
+    return;
+  }
+  target->vertex_attrib_divisor(index, divisor);
+  this_attrib.divisor = divisor;
+}
+void backend_cache::vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Set an attribute's constant value unless it's already known to hold it
+  values const new_values{x, y, z, w};
+  auto const it = attrib_constants.find(index);
+  if(it != attrib_constants.end() && it->second == new_values) {
+    ++skipped;
+    return;
+  }
+  target->vertex_attrib4f(index, x, y, z, w);
+  attrib_constants[index] = new_values;
+}
+
+GLuint backend_cache::gen_texture() {
+  /// Pass through to the target
+  return target->gen_texture();
+}
+void backend_cache::delete_texture(GLuint texture) {
+  /// Delete a texture, forgetting any bindings of it, which deleting resets to zero
+  for(auto &it : textures) {
+    if(it.second == texture) {
+      it.second = 0;
+    }
+  }
+  target->delete_texture(texture);
+}
+void backend_cache::bind_texture(GLenum texture_target, GLuint texture) {
+  /// Bind a texture unless it's already known to be bound
+  auto const it = textures.find(texture_target);
+  if(it != textures.end() && it->second == texture) {
+    ++skipped;
+    return;
+  }
+  target->bind_texture(texture_target, texture);
+  textures[texture_target] = texture;
+}
+void backend_cache::tex_parameter(GLenum texture_target, GLenum name, GLint value) {
+  /// Pass through to the target
+  target->tex_parameter(texture_target, name, value);
+}
+void backend_cache::tex_image_2d(GLenum texture_target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) {
+  /// Pass through to the target
+  target->tex_image_2d(texture_target, internal_format, width, height, format, type, data);
+}
+void backend_cache::tex_sub_image_2d(GLenum texture_target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) {
+  /// Pass through to the target
+  target->tex_sub_image_2d(texture_target, x, y, width, height, format, type, data);
+}
+
+GLuint backend_cache::gen_framebuffer() {
+  /// Pass through to the target
+  return target->gen_framebuffer();
+}
+void backend_cache::delete_framebuffer(GLuint framebuffer) {
+  /// Pass through to the target
+  target->delete_framebuffer(framebuffer);
+}
+void backend_cache::bind_framebuffer(GLenum framebuffer_target, GLuint framebuffer) {
+  /// Pass through to the target
+  target->bind_framebuffer(framebuffer_target, framebuffer);
+}
+void backend_cache::framebuffer_texture_2d(GLenum framebuffer_target, GLenum attachment, GLenum texture_target, GLuint texture) {
+  /// Pass through to the target
+  target->framebuffer_texture_2d(framebuffer_target, attachment, texture_target, texture);
+}
+GLenum backend_cache::check_framebuffer_status(GLenum framebuffer_target) {
+  /// Pass through to the target
+  return target->check_framebuffer_status(framebuffer_target);
+}
+
+void backend_cache::clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  /// Pass through to the target
+  target->clear_colour_buffer(r, g, b, a);
+}
+void backend_cache::draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) {
+  /// Pass through to the target
+  target->draw_elements(mode, count, type, offset);
+}
+void backend_cache::draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) {
+  /// Pass through to the target
+  target->draw_elements_instanced(mode, count, type, offset, instances);
+}
+
+void backend_cache::forget_vertex_array_state() {
+  /// Forget everything that belongs to the bound vertex array object, after switching to another
+  attribs.clear();
+  buffers.erase(GL_ELEMENT_ARRAY_BUFFER);                                       // the element array binding is part of the vertex array object too
+}
+
+}
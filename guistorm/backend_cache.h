@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include "backend.h"
+
+namespace guistorm {
+
+class backend_cache final : public backend {
+  /// Sits in front of another backend and remembers the state it has set, so
+  /// binds, enables, attribute setup and uniform updates that wouldn't change
+  /// anything are dropped before they reach the driver.  The gui shares its
+  /// context with the application, which may change any state between frames,
+  /// so everything is forgotten with invalidate() at the start of each frame,
+  /// and again at its end for work done between frames, such as loading glyphs;
+  /// state that lasts between frames is kept in a vertex array object instead.
+  /// Only state we've set ourselves is trusted - anything unknown is passed on.
+  struct attrib_pointer {
+    GLuint buffer;                                                              // the array buffer bound when the pointer was set
+    GLint size;
+    GLenum type;
+    GLboolean normalised;
+    GLsizei stride;
+    size_t offset;
+    bool operator==(attrib_pointer const &other) const __attribute__((__pure__));
+  };
+  struct attrib {
+    /// What we know about one vertex attribute in the bound vertex array object
+    std::optional<bool> enabled;
+    std::optional<attrib_pointer> pointer;
+    std::optional<GLuint> divisor;
+  };
+  using values = std::array<GLfloat, 4>;                                        // uniform or constant attribute values, unused components zero
+
+  backend *target;                                                              // where calls that change something are passed on to
+
+  std::unordered_map<GLenum, bool> capabilities;                                // known enabled state of each capability
+  std::optional<GLuint> program;                                                // known current program
+  std::unordered_map<GLint, values> uniforms;                                   // known uniform values in the current program
+  std::unordered_map<GLenum, GLuint> buffers;                                   // known buffer bound to each target
+  std::optional<GLuint> vertex_array;                                           // known bound vertex array object
+  std::unordered_map<GLuint, attrib> attribs;                                   // known state of each attribute in the bound vertex array object
+  std::unordered_map<GLuint, values> attrib_constants;                          // known constant values of each attribute, used while its array is disabled
+  std::unordered_map<GLenum, GLuint> textures;                                  // known texture bound to each target
+
+  unsigned int skipped = 0;                                                     // calls dropped since the last take_skipped()
+
+public:
+  backend_cache(backend &target);
+  ~backend_cache() override;
+
+  void set_target(backend &new_target);
+  backend &get_target() __attribute__((__pure__));
+  void invalidate();
+  unsigned int take_skipped();
+
+  bool has_context() override final;
+  GLint get_max_texture_size() override final;
+  bool has_instancing() override final;
+  bool has_vertex_arrays() override final;
+  bool has_framebuffers() override final;
+
+  void enable( GLenum capability) override final;
+  void disable(GLenum capability) override final;
+  void blend_func(GLenum source, GLenum destination) override final;
+  void blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) override final;
+  void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override final;
+  void scissor( GLint x, GLint y, GLsizei width, GLsizei height) override final;
+  void get_integerv(GLenum name, GLint *values) override final;
+
+  GLuint load_program(std::string const &vertex, std::string const &fragment) override final;
+  void delete_program(GLuint program) override final;
+  void use_program(GLuint program) override final;
+  GLint get_attrib_location( GLuint program, char const *name) override final;
+  GLint get_uniform_location(GLuint program, char const *name) override final;
+  void uniform1f(GLint location, GLfloat x) override final;
+  void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override final;
+
+  GLuint gen_buffer() override final;
+  void delete_buffer(GLuint buffer) override final;
+  void bind_buffer(GLenum target, GLuint buffer) override final;
+  void buffer_data(GLenum target, GLsizeiptr size, void const *data, GLenum usage) override final;
+
+  GLuint gen_vertex_array() override final;
+  void delete_vertex_array(GLuint vertex_array) override final;
+  void bind_vertex_array(GLuint vertex_array) override final;
+
+  void enable_vertex_attrib_array( GLuint index) override final;
+  void disable_vertex_attrib_array(GLuint index) override final;
+  void vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) override final;
+  void vertex_attrib_divisor(GLuint index, GLuint divisor) override final;
+  void vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override final;
+
+  GLuint gen_texture() override final;
+  void delete_texture(GLuint texture) override final;
+  void bind_texture(GLenum target, GLuint texture) override final;
+  void tex_parameter(GLenum target, GLenum name, GLint value) override final;
+  void tex_image_2d(    GLenum target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) override final;
+  void tex_sub_image_2d(GLenum target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) override final;
+
+  GLuint gen_framebuffer() override final;
+  void delete_framebuffer(GLuint framebuffer) override final;
+  void bind_framebuffer(GLenum target, GLuint framebuffer) override final;
+  void framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture) override final;
+  GLenum check_framebuffer_status(GLenum target) override final;
+
+  void clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override final;
+  void draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) override final;
+  void draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) override final;
+
+private:
+  void forget_vertex_array_state();
+};
+
+}
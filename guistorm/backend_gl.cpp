@@ -0,0 +1,218 @@
+#include "backend_gl.h"
+#include <GLFW/glfw3.h>
+#include "shader_load.h"
+
+namespace guistorm {
+
+backend_gl::backend_gl() {
+  /// Default constructor
+}
+
+backend_gl::~backend_gl() {
+  /// Default destructor
+}
+
+bool backend_gl::has_context() {
+  /// Return whether there's a current OpenGL context to make calls into
+  return glfwGetCurrentContext() != NULL;
+}
+GLint backend_gl::get_max_texture_size() {
+  /// Return the largest texture width or height the driver supports
+  GLint maxtexture;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxtexture);
+  return maxtexture;
+}
+bool backend_gl::has_instancing() {
+  /// Return whether instanced drawing with per-instance attributes is available
+  return GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced;
+}
+bool backend_gl::has_vertex_arrays() {
+  /// Return whether vertex array objects are available
+  return GLEW_VERSION_3_0 || GLEW_ARB_vertex_array_object;
+}
+bool backend_gl::has_framebuffers() {
+  /// Return whether framebuffer objects are available to render into textures
+  return GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object;
+}
+
+void backend_gl::enable(GLenum capability) {
+  /// Pass through to glEnable
+  glEnable(capability);
+}
+void backend_gl::disable(GLenum capability) {
+  /// Pass through to glDisable
+  glDisable(capability);
+}
+void backend_gl::blend_func(GLenum source, GLenum destination) {
+  /// Pass through to glBlendFunc
+  glBlendFunc(source, destination);
+}
+void backend_gl::blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) {
+  /// Pass through to glBlendFuncSeparate
+  glBlendFuncSeparate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+}
+void backend_gl::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Pass through to glViewport
+  glViewport(x, y, width, height);
+}
+void backend_gl::scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Pass through to glScissor
+  glScissor(x, y, width, height);
+}
+void backend_gl::get_integerv(GLenum name, GLint *values) {
+  /// Pass through to glGetIntegerv
+  glGetIntegerv(name, values);
+}
+
+GLuint backend_gl::load_program(std::string const &vertex, std::string const &fragment) {
+  /// Compile and link a shader program from vertex and fragment sources
+  return shader_load(vertex, fragment);
+}
+void backend_gl::delete_program(GLuint program) {
+  /// Pass through to glDeleteProgram
+  glDeleteProgram(program);
+}
+void backend_gl::use_program(GLuint program) {
+  /// Pass through to glUseProgram
+  glUseProgram(program);
+}
+GLint backend_gl::get_attrib_location(GLuint program, char const *name) {
+  /// Pass through to glGetAttribLocation
+  return glGetAttribLocation(program, name);
+}
+GLint backend_gl::get_uniform_location(GLuint program, char const *name) {
+  /// Pass through to glGetUniformLocation
+  return glGetUniformLocation(program, name);
+}
+void backend_gl::uniform1f(GLint location, GLfloat x) {
+  /// Pass through to glUniform1f
+  glUniform1f(location, x);
+}
+void backend_gl::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Pass through to glUniform4f
+  glUniform4f(location, x, y, z, w);
+}
+
+GLuint backend_gl::gen_buffer() {
+  /// Pass through to glGenBuffers
+  GLuint buffer;
+  glGenBuffers(1, &buffer);
+  return buffer;
+}
+void backend_gl::delete_buffer(GLuint buffer) {
+  /// Pass through to glDeleteBuffers
+  glDeleteBuffers(1, &buffer);
+}
+void backend_gl::bind_buffer(GLenum target, GLuint buffer) {
+  /// Pass through to glBindBuffer
+  glBindBuffer(target, buffer);
+}
+void backend_gl::buffer_data(GLenum target, GLsizeiptr size, void const *data, GLenum usage) {
+  /// Pass through to glBufferData
+  glBufferData(target, size, data, usage);
+}
+
+GLuint backend_gl::gen_vertex_array() {
+  /// Pass through to glGenVertexArrays
+  GLuint vertex_array;
+  glGenVertexArrays(1, &vertex_array);
+  return vertex_array;
+}
+void backend_gl::delete_vertex_array(GLuint vertex_array) {
+  /// Pass through to glDeleteVertexArrays
+  glDeleteVertexArrays(1, &vertex_array);
+}
+void backend_gl::bind_vertex_array(GLuint vertex_array) {
+  /// Pass through to glBindVertexArray
+  glBindVertexArray(vertex_array);
+}
+
+void backend_gl::enable_vertex_attrib_array(GLuint index) {
+  /// Pass through to glEnableVertexAttribArray
+  glEnableVertexAttribArray(index);
+}
+void backend_gl::disable_vertex_attrib_array(GLuint index) {
+  /// Pass through to glDisableVertexAttribArray
+  glDisableVertexAttribArray(index);
+}
+void backend_gl::vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) {
+  /// Pass through to glVertexAttribPointer
+  glVertexAttribPointer(index, size, type, normalised, stride, reinterpret_cast<GLvoid*>(offset));
+}
+void backend_gl::vertex_attrib_divisor(GLuint index, GLuint divisor) {
+  /// Pass through to glVertexAttribDivisorARB
+  glVertexAttribDivisorARB(index, divisor);
+}
+void backend_gl::vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Pass through to glVertexAttrib4f
+  glVertexAttrib4f(index, x, y, z, w);
+}
+
+GLuint backend_gl::gen_texture() {
+  /// Pass through to glGenTextures
+  GLuint texture;
+  glGenTextures(1, &texture);
+  return texture;
+}
+void backend_gl::delete_texture(GLuint texture) {
+  /// Pass through to glDeleteTextures
+  glDeleteTextures(1, &texture);
+}
+void backend_gl::bind_texture(GLenum target, GLuint texture) {
+  /// Pass through to glBindTexture
+  glBindTexture(target, texture);
+}
+void backend_gl::tex_parameter(GLenum target, GLenum name, GLint value) {
+  /// Pass through to glTexParameteri
+  glTexParameteri(target, name, value);
+}
+void backend_gl::tex_image_2d(GLenum target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) {
+  /// Pass through to glTexImage2D
+  glTexImage2D(target, 0, internal_format, width, height, 0, format, type, data);
+}
+void backend_gl::tex_sub_image_2d(GLenum target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) {
+  /// Pass through to glTexSubImage2D
+  glTexSubImage2D(target, 0, x, y, width, height, format, type, data);
+}
+
+GLuint backend_gl::gen_framebuffer() {
+  /// Pass through to glGenFramebuffers
+  GLuint framebuffer;
+  glGenFramebuffers(1, &framebuffer);
+  return framebuffer;
+}
+void backend_gl::delete_framebuffer(GLuint framebuffer) {
+  /// Pass through to glDeleteFramebuffers
+  glDeleteFramebuffers(1, &framebuffer);
+}
+void backend_gl::bind_framebuffer(GLenum target, GLuint framebuffer) {
+  /// Pass through to glBindFramebuffer
+  glBindFramebuffer(target, framebuffer);
+}
+void backend_gl::framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture) {
+  /// Pass through to glFramebufferTexture2D
+  glFramebufferTexture2D(target, attachment, texture_target, texture, 0);
+}
+GLenum backend_gl::check_framebuffer_status(GLenum target) {
+  /// Pass through to glCheckFramebufferStatus
+  return glCheckFramebufferStatus(target);
+}
+
+void backend_gl::clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  /// Clear the colour buffer of the bound framebuffer, leaving the application's clear colour as we found it
+  GLfloat clear_colour_previous[4];
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_colour_previous);
+  glClearColor(r, g, b, a);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glClearColor(clear_colour_previous[0], clear_colour_previous[1], clear_colour_previous[2], clear_colour_previous[3]);
+}
+void backend_gl::draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) {
+  /// Pass through to glDrawElements
+  glDrawElements(mode, count, type, reinterpret_cast<GLvoid*>(offset));
+}
+void backend_gl::draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) {
+  /// Pass through to glDrawElementsInstancedARB
+  glDrawElementsInstancedARB(mode, count, type, reinterpret_cast<GLvoid*>(offset), instances);
+}
+
+}
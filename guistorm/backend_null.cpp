@@ -0,0 +1,360 @@
+#include "backend_null.h"
+#include <algorithm>
+
+namespace guistorm {
+
+backend_null::backend_null() {
+  /// Default constructor
+}
+
+backend_null::~backend_null() {
+  /// Default destructor
+}
+
+void backend_null::reset_statistics() {
+  /// Zero all the running totals, and discard the log
+  stats = statistics();
+  log.clear();
+}
+
+bool backend_null::has_context() {
+  /// Report whatever context state we've been told to pretend to have
+  return has_context_value;
+}
+GLint backend_null::get_max_texture_size() {
+  /// Report whatever texture size limit we've been told to pretend to have
+  return max_texture_size;
+}
+bool backend_null::has_instancing() {
+  /// Report whether we've been told to pretend instancing is available
+  return has_instancing_value;
+}
+bool backend_null::has_vertex_arrays() {
+  /// Report whether we've been told to pretend vertex array objects are available
+  return has_vertex_arrays_value;
+}
+bool backend_null::has_framebuffers() {
+  /// Report whatever framebuffer support we've been told to pretend to have
+  return has_framebuffers_value;
+}
+
+void backend_null::enable(GLenum capability) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("enable " + std::to_string(capability));
+  }
+}
+void backend_null::disable(GLenum capability) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("disable " + std::to_string(capability));
+  }
+}
+
+void backend_null::blend_func(GLenum source, GLenum destination) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("blend_func " + std::to_string(source) + " " + std::to_string(destination));
+  }
+}
+void backend_null::blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("blend_func_separate " + std::to_string(source_rgb) + " " + std::to_string(destination_rgb) + " " + std::to_string(source_alpha) + " " + std::to_string(destination_alpha));
+  }
+}
+void backend_null::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("viewport " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " + std::to_string(height));
+  }
+}
+void backend_null::scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("scissor " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " + std::to_string(height));
+  }
+}
+void backend_null::get_integerv(GLenum name, GLint *values) {
+  /// Report zeros, as no state is tracked - enough for anything that only saves state to restore it
+  std::fill_n(values, name == GL_VIEWPORT || name == GL_SCISSOR_BOX ? 4 : 1, 0);
+  if(recording) {
+    record("get_integerv " + std::to_string(name));
+  }
+}
+
+GLuint backend_null::load_program(std::string const &vertex [[maybe_unused]], std::string const &fragment [[maybe_unused]]) {
+  /// Pretend to compile a shader program, returning a new unique name
+  if(recording) {
+    record("load_program " + std::to_string(next_name));
+  }
+  return next_name++;
+}
+void backend_null::delete_program(GLuint program) {
+  /// Pretend to delete a shader program
+  if(recording) {
+    record("delete_program " + std::to_string(program));
+  }
+}
+void backend_null::use_program(GLuint program) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("use_program " + std::to_string(program));
+  }
+}
+GLint backend_null::get_attrib_location(GLuint program [[maybe_unused]], char const *name [[maybe_unused]]) {
+  /// Return a new unique attribute location
+  return static_cast<GLint>(next_name++);
+}
+GLint backend_null::get_uniform_location(GLuint program [[maybe_unused]], char const *name [[maybe_unused]]) {
+  /// Return a new unique uniform location
+  return static_cast<GLint>(next_name++);
+}
+void backend_null::uniform1f(GLint location, GLfloat x) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("uniform1f " + std::to_string(location) + " " + std::to_string(x));
+  }
+}
+void backend_null::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("uniform4f " + std::to_string(location) + " " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z) + " " + std::to_string(w));
+  }
+}
+
+GLuint backend_null::gen_buffer() {
+  /// Pretend to generate a buffer, returning a new unique name
+  if(recording) {
+    record("gen_buffer " + std::to_string(next_name));
+  }
+  return next_name++;
+}
+void backend_null::delete_buffer(GLuint buffer) {
+  /// Pretend to delete a buffer
+  if(recording) {
+    record("delete_buffer " + std::to_string(buffer));
+  }
+}
+void backend_null::bind_buffer(GLenum target, GLuint buffer) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("bind_buffer " + std::to_string(target) + " " + std::to_string(buffer));
+  }
+}
+void backend_null::buffer_data(GLenum target, GLsizeiptr size, void const *data [[maybe_unused]], GLenum usage) {
+  /// Count an upload and the bytes it would have sent
+  ++stats.buffer_uploads;
+  stats.bytes_uploaded += static_cast<size_t>(size);
+  if(recording) {
+    record("buffer_data " + std::to_string(target) + " " + std::to_string(size) + " " + std::to_string(usage));
+  }
+}
+
+GLuint backend_null::gen_vertex_array() {
+  /// Pretend to generate a vertex array object, returning a new unique name
+  if(recording) {
+    record("gen_vertex_array " + std::to_string(next_name));
+  }
+  return next_name++;
+}
+void backend_null::delete_vertex_array(GLuint vertex_array) {
+  /// Pretend to delete a vertex array object
+  if(recording) {
+    record("delete_vertex_array " + std::to_string(vertex_array));
+  }
+}
+void backend_null::bind_vertex_array(GLuint vertex_array) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("bind_vertex_array " + std::to_string(vertex_array));
+  }
+}
+
+void backend_null::enable_vertex_attrib_array(GLuint index) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("enable_vertex_attrib_array " + std::to_string(index));
+  }
+}
+void backend_null::disable_vertex_attrib_array(GLuint index) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("disable_vertex_attrib_array " + std::to_string(index));
+  }
+}
+void backend_null::vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("vertex_attrib_pointer " + std::to_string(index) + " " + std::to_string(size) + " " + std::to_string(type) + " " + std::to_string(normalised) + " " + std::to_string(stride) + " " + std::to_string(offset));
+  }
+}
+void backend_null::vertex_attrib_divisor(GLuint index, GLuint divisor) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("vertex_attrib_divisor " + std::to_string(index) + " " + std::to_string(divisor));
+  }
+}
+void backend_null::vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("vertex_attrib4f " + std::to_string(index) + " " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z) + " " + std::to_string(w));
+  }
+}
+
+GLuint backend_null::gen_texture() {
+  /// Pretend to generate a texture, returning a new unique name
+  if(recording) {
+    record("gen_texture " + std::to_string(next_name));
+  }
+  return next_name++;
+}
+void backend_null::delete_texture(GLuint texture) {
+  /// Pretend to delete a texture
+  if(recording) {
+    record("delete_texture " + std::to_string(texture));
+  }
+}
+void backend_null::bind_texture(GLenum target, GLuint texture) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("bind_texture " + std::to_string(target) + " " + std::to_string(texture));
+  }
+}
+void backend_null::tex_parameter(GLenum target, GLenum name, GLint value) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("tex_parameter " + std::to_string(target) + " " + std::to_string(name) + " " + std::to_string(value));
+  }
+}
+void backend_null::tex_image_2d(GLenum target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) {
+  /// Count a texture upload and the bytes it would have sent
+  ++stats.texture_uploads;
+  if(data) {
+    stats.bytes_uploaded += static_cast<size_t>(width) * static_cast<size_t>(height) * get_texel_size(format, type);
+  }
+  if(recording) {
+    record("tex_image_2d " + std::to_string(target) + " " + std::to_string(internal_format) + " " + std::to_string(width) + " " + std::to_string(height) + " " + std::to_string(format) + " " + std::to_string(type));
+  }
+}
+void backend_null::tex_sub_image_2d(GLenum target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data [[maybe_unused]]) {
+  /// Count a texture upload and the bytes it would have sent
+  ++stats.texture_uploads;
+  stats.bytes_uploaded += static_cast<size_t>(width) * static_cast<size_t>(height) * get_texel_size(format, type);
+  if(recording) {
+    record("tex_sub_image_2d " + std::to_string(target) + " " + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " + std::to_string(height) + " " + std::to_string(format) + " " + std::to_string(type));
+  }
+}
+
+GLuint backend_null::gen_framebuffer() {
+  /// Pretend to generate a framebuffer, returning a new unique name
+  if(recording) {
+    record("gen_framebuffer " + std::to_string(next_name));
+  }
+  return next_name++;
+}
+void backend_null::delete_framebuffer(GLuint framebuffer) {
+  /// Pretend to delete a framebuffer
+  if(recording) {
+    record("delete_framebuffer " + std::to_string(framebuffer));
+  }
+}
+void backend_null::bind_framebuffer(GLenum target, GLuint framebuffer) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("bind_framebuffer " + std::to_string(target) + " " + std::to_string(framebuffer));
+  }
+}
+void backend_null::framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture) {
+  /// Count a state change
+  ++stats.state_changes;
+  if(recording) {
+    record("framebuffer_texture_2d " + std::to_string(target) + " " + std::to_string(attachment) + " " + std::to_string(texture_target) + " " + std::to_string(texture));
+  }
+}
+GLenum backend_null::check_framebuffer_status(GLenum target) {
+  /// Report every framebuffer as complete
+  if(recording) {
+    record("check_framebuffer_status " + std::to_string(target));
+  }
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void backend_null::clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  /// Pretend to clear the bound framebuffer
+  if(recording) {
+    record("clear_colour_buffer " + std::to_string(r) + " " + std::to_string(g) + " " + std::to_string(b) + " " + std::to_string(a));
+  }
+}
+void backend_null::draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) {
+  /// Count a draw call and the indices it would have drawn
+  ++stats.draw_calls;
+  stats.indices_drawn += static_cast<size_t>(count);
+  if(recording) {
+    record("draw_elements " + std::to_string(mode) + " " + std::to_string(count) + " " + std::to_string(type) + " " + std::to_string(offset));
+  }
+}
+void backend_null::draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) {
+  /// Count a draw call and the indices it would have drawn over all instances
+  ++stats.draw_calls;
+  stats.indices_drawn += static_cast<size_t>(count) * static_cast<size_t>(instances);
+  if(recording) {
+    record("draw_elements_instanced " + std::to_string(mode) + " " + std::to_string(count) + " " + std::to_string(type) + " " + std::to_string(offset) + " " + std::to_string(instances));
+  }
+}
+
+void backend_null::record(std::string const &call) {
+  /// Append a call to the log
+  log.emplace_back(call);
+}
+
+size_t backend_null::get_texel_size(GLenum format, GLenum type) {
+  /// Return how many bytes each texel of pixel data in this format would take
+  size_t components;
+  switch(format) {
+  case GL_RGBA:
+    components = 4;
+    break;
+  case GL_RGB:
+    components = 3;
+    break;
+  case GL_RG:
+    components = 2;
+    break;
+  default:                                                                      // GL_ALPHA, GL_RED etc
+    components = 1;
+    break;
+  }
+  switch(type) {
+  case GL_FLOAT:
+  case GL_UNSIGNED_INT:
+  case GL_INT:
+    return components * 4;
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+    return components * 2;
+  default:                                                                      // GL_UNSIGNED_BYTE etc
+    return components;
+  }
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include "backend.h"
+
+namespace guistorm {
+
+class backend_null final : public backend {
+  /// Headless backend that draws nothing but counts what would have been sent
+  /// to the gpu, so layout, label arrangement, geometry generation and atlas
+  /// packing can be run, tested and profiled on a machine with no display.
+  /// Optionally keeps a log of every call made, for comparing against expected
+  /// call sequences in tests.
+public:
+  struct statistics {
+    /// Running totals of what has been submitted, reset with reset_statistics()
+    unsigned int draw_calls      = 0;                                           // draw_elements and draw_elements_instanced calls
+    size_t indices_drawn         = 0;                                           // total index count over all draw calls, counting every instance
+    size_t bytes_uploaded        = 0;                                           // total buffer and texture data uploaded, in bytes
+    unsigned int buffer_uploads  = 0;                                           // buffer_data calls
+    unsigned int texture_uploads = 0;                                           // tex_image_2d and tex_sub_image_2d calls
+    unsigned int state_changes   = 0;                                           // enables, disables, binds, program, vertex array, framebuffer and attribute changes and uniform updates
+  };
+
+  statistics stats;                                                             // totals since construction or the last reset
+  bool has_context_value = true;                                                // what to report from has_context()
+  GLint max_texture_size = 16384;                                               // what to report from get_max_texture_size()
+  bool has_instancing_value = true;                                             // what to report from has_instancing()
+  bool has_vertex_arrays_value = true;                                          // what to report from has_vertex_arrays()
+  bool has_framebuffers_value = true;                                           // what to report from has_framebuffers()
+
+  bool recording = false;                                                       // whether to keep a textual log of every call
+  std::vector<std::string> log;                                                 // calls made while recording, oldest first
+
+private:
+  GLuint next_name = 1;                                                         // every generated object gets a unique nonzero name
+
+public:
+  backend_null();
+  ~backend_null() override;
+
+  void reset_statistics();
+
+  bool has_context() override final;
+  GLint get_max_texture_size() override final;
+  bool has_instancing() override final;
+  bool has_vertex_arrays() override final;
+  bool has_framebuffers() override final;
+
+  void enable( GLenum capability) override final;
+  void disable(GLenum capability) override final;
+  void blend_func(GLenum source, GLenum destination) override final;
+  void blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) override final;
+  void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override final;
+  void scissor( GLint x, GLint y, GLsizei width, GLsizei height) override final;
+  void get_integerv(GLenum name, GLint *values) override final;
+
+  GLuint load_program(std::string const &vertex, std::string const &fragment) override final;
+  void delete_program(GLuint program) override final;
+  void use_program(GLuint program) override final;
+  GLint get_attrib_location( GLuint program, char const *name) override final;
+  GLint get_uniform_location(GLuint program, char const *name) override final;
+  void uniform1f(GLint location, GLfloat x) override final;
+  void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override final;
+
+  GLuint gen_buffer() override final;
+  void delete_buffer(GLuint buffer) override final;
+  void bind_buffer(GLenum target, GLuint buffer) override final;
+  void buffer_data(GLenum target, GLsizeiptr size, void const *data, GLenum usage) override final;
+
+  GLuint gen_vertex_array() override final;
+  void delete_vertex_array(GLuint vertex_array) override final;
+  void bind_vertex_array(GLuint vertex_array) override final;
+
+  void enable_vertex_attrib_array( GLuint index) override final;
+  void disable_vertex_attrib_array(GLuint index) override final;
+  void vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, size_t offset) override final;
+  void vertex_attrib_divisor(GLuint index, GLuint divisor) override final;
+  void vertex_attrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override final;
+
+  GLuint gen_texture() override final;
+  void delete_texture(GLuint texture) override final;
+  void bind_texture(GLenum target, GLuint texture) override final;
+  void tex_parameter(GLenum target, GLenum name, GLint value) override final;
+  void tex_image_2d(    GLenum target, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) override final;
+  void tex_sub_image_2d(GLenum target, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const *data) override final;
+
+  GLuint gen_framebuffer() override final;
+  void delete_framebuffer(GLuint framebuffer) override final;
+  void bind_framebuffer(GLenum target, GLuint framebuffer) override final;
+  void framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture) override final;
+  GLenum check_framebuffer_status(GLenum target) override final;
+
+  void clear_colour_buffer(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override final;
+  void draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) override final;
+  void draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) override final;
+
+private:
+  void record(std::string const &call);
+  static size_t get_texel_size(GLenum format, GLenum type) __attribute__((__const__));
+};
+
+}
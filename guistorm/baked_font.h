@@ -0,0 +1,45 @@
+#pragma once
+
+namespace guistorm {
+
+struct baked_font {
+  /// A font rasterised ahead of time by the bake_font tool, and compiled in as
+  /// constant data, so it loads in microseconds without freetype.  The tool
+  /// writes a header defining one of these, along with the arrays it points
+  /// to; pass it to gui::add_font.  Its glyph bitmaps are copied into the
+  /// gui's font atlas alongside any other fonts when the fonts are loaded.
+  struct glyph {
+    char32_t charcode;
+    bool is_blank;                                                              // for spaces and other invisible horizontal whitespace glyphs
+    bool linebreak;                                                             // whether to add a line break after this glyph
+    unsigned short atlas_x;                                                     // where the glyph's bitmap starts in the baked atlas, in pixels
+    unsigned short atlas_y;
+    float offset[2];                                                            // lower-left corner of the quad
+    float size[2];                                                              // size of the quad, and of the bitmap in pixels
+    float advance[2];                                                           // how far this moves the cursor forward after it's placed
+    unsigned int kerning_first;                                                 // this glyph's kerning pairs, a range of the kerning array
+    unsigned int kerning_count;
+  };
+  struct kerning_pair {
+    /// Kerning for a glyph after a preceding character - only non-zero pairs are baked
+    char32_t charcode_last;
+    float kerning;
+  };
+
+  char const *name;
+  float font_size;                                                              // size the font was baked at, in points
+  float dpi;                                                                    // dots per inch the font was baked for
+  float metrics_ascender;
+  float metrics_descender;
+  float metrics_height;
+  float metrics_linegap;
+  unsigned int atlas_width;                                                     // size of the baked atlas bitmap, in pixels
+  unsigned int atlas_height;
+  unsigned char const *atlas;                                                   // one byte of coverage per pixel, rows in the same order as the font atlas
+  glyph const *glyphs;
+  unsigned int glyph_count;
+  kerning_pair const *kerning;
+  unsigned int kerning_count;
+};
+
+}
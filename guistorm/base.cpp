@@ -1,4 +1,5 @@
 #include "base.h"
+#include <algorithm>
 #include <iostream>
 #include "cast_if_required.h"
 #include "rounding.h"
@@ -54,29 +55,60 @@ base::base(container *newparent,
     size.x     = GUISTORM_ROUND(size.x);
     size.y     = GUISTORM_ROUND(size.y);
   #endif // GUISTORM_ROUND_NEAREST_ALL
+  invalidate(dirty_geometry | dirty_label);                                     // build everything before this is first drawn
+  restart_colour_transition();                                                  // settle into the idle colours
 }
 
 base::~base() {
   /// Default destructor
   destroy_buffer();
+  damage_drawn();                                                               // nothing will be drawn where we were
+  #ifdef GUISTORM_PICK_GRID
+    if(parent_gui) {
+      parent_gui->pick_index.forget(this);
+    }
+  #endif // GUISTORM_PICK_GRID
+  if(dirty != 0 && parent_gui) {                                                // make sure we're not left waiting for a rebuild after we're gone
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(parent_gui->dirty_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    auto &dirty_elements(parent_gui->dirty_elements);
+    dirty_elements.erase(std::remove(dirty_elements.begin(), dirty_elements.end(), this), dirty_elements.end());
+  }
+  if(animating && parent_gui) {                                                 // or left animating
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(parent_gui->animating_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    auto &animating_elements(parent_gui->animating_elements);
+    animating_elements.erase(std::remove(animating_elements.begin(), animating_elements.end(), this), animating_elements.end());
+  }
 }
 
 void base::show() {
   /// Make this element visible for rendering
   visible = true;
+  reindex_picking();
+  invalidate_appearance();
 }
 void base::hide() {
   /// Do not render this element
   visible = false;
+  reindex_picking();
+  damage_drawn();
+  invalidate_appearance();
 }
 void base::toggle() {
   /// Flip the rendering state of this element
   visible = !visible;
+  reindex_picking();
+  if(!visible) {
+    damage_drawn();
+  }
+  invalidate_appearance();
 }
 void base::set_position(coordtype const &new_position) {
   /// Update this element's relative position to its parent element or the screen centre if parentless, lower left corner
   set_position_nodpiscale(new_position * parent_gui->get_dpi_scale());
-  refresh_position_only();
 }
 void base::set_position(coordcomponent new_position_x, coordcomponent new_position_y) {
   set_position(coordtype(new_position_x, new_position_y));                      // wrapper
@@ -88,7 +120,14 @@ void base::set_position_nodpiscale(coordtype const &new_position) {
     position.x = GUISTORM_ROUND(position.x);
     position.y = GUISTORM_ROUND(position.y);
   #endif // GUISTORM_ROUND_NEAREST_ALL
-  refresh_position_only();
+  // geometry is relative to the origin, so moving requires no refresh
+  invalidate_absolute_position();
+  reindex_picking();
+  if(parent_base) {
+    parent_base->invalidate_render_cache();                                     // a cached window's contents are relative to it, so only those around us are affected
+  } else if(parent_gui) {
+    parent_gui->request_redraw();                                               // nothing around us to invalidate, but the gui still has to draw us somewhere new
+  }
 }
 void base::set_position_nodpiscale(coordcomponent new_position_x, coordcomponent new_position_y) {
   set_position_nodpiscale(coordtype(new_position_x, new_position_y));           // wrapper
@@ -96,7 +135,6 @@ void base::set_position_nodpiscale(coordcomponent new_position_x, coordcomponent
 void base::set_size(coordtype const &new_size) {
   /// Update this element's size
   set_size_nodpiscale(new_size * parent_gui->get_dpi_scale());
-  refresh_position_only();
 }
 void base::set_size(coordcomponent new_size_x, coordcomponent new_size_y) {
   set_size(coordtype(new_size_x, new_size_y));                                  // wrapper
@@ -120,7 +158,13 @@ void base::move(coordtype const &offset) {
     position.x = GUISTORM_ROUND(position.x);
     position.y = GUISTORM_ROUND(position.y);
   #endif // GUISTORM_ROUND_NEAREST_ALL
-  refresh_position_only();
+  invalidate_absolute_position();
+  reindex_picking();
+  if(parent_base) {
+    parent_base->invalidate_render_cache();                                     // a cached window's contents are relative to it, so only those around us are affected
+  } else if(parent_gui) {
+    parent_gui->request_redraw();                                               // nothing around us to invalidate, but the gui still has to draw us somewhere new
+  }
 }
 void base::grow(coordtype const &increase) {
   /// Scale this element up by a specified increase
@@ -217,26 +261,82 @@ void base::shrink_to_label_vertically() {
 void base::set_colours(colourset const &new_colours) {
   /// Update the full set of current colours from an existing colourset
   colours = new_colours;
+  restart_colour_transition();
 }
 void base::set_colour(colourtype const &background, colourtype const &outline, colourtype const &content) {
   /// Update the current (momentary) colour - use this for initial colours, fade-ins and flashing effects
   colours.current.assign(background, outline, content);
+  restart_colour_transition();                                                  // fade from here back to whatever state we're in
 }
 void base::set_colour_default(colourtype const &background, colourtype const &outline, colourtype const &content) {
   /// Update the default colour used when this element is idle
-  colours.idle.assign(background, outline, content);
+  palette new_palette(colours.get_palette());                                   // copy on write, so any others sharing our palette are left alone
+  new_palette.idle.assign(background, outline, content);
+  set_palette(palette::intern(new_palette));
 }
 void base::set_colour_hover(colourtype const &background, colourtype const &outline, colourtype const &content) {
   /// Update the colour to fade to when moused over
-  colours.hover.assign(background, outline, content);
+  palette new_palette(colours.get_palette());
+  new_palette.hover.assign(background, outline, content);
+  set_palette(palette::intern(new_palette));
 }
 void base::set_colour_focus(colourtype const &background, colourtype const &outline, colourtype const &content) {
   /// Update the colour to fade to when focused, i.e. with keyboard selection
-  colours.focus.assign(background, outline, content);
+  palette new_palette(colours.get_palette());
+  new_palette.focus.assign(background, outline, content);
+  set_palette(palette::intern(new_palette));
 }
 void base::set_colour_active(colourtype const &background, colourtype const &outline, colourtype const &content) {
   /// Update the colour to fade to when activated, i.e. clicked or dragged or text has been entered
-  colours.active.assign(background, outline, content);
+  palette new_palette(colours.get_palette());
+  new_palette.active.assign(background, outline, content);
+  set_palette(palette::intern(new_palette));
+}
+void base::set_palette(std::shared_ptr<palette const> const &new_palette) {
+  /// Draw this element with a different palette, such as a theme shared with other elements
+  /// To restyle everything using a theme at once, assign to the theme itself and call gui::restyle()
+  if(!parent_gui) {
+    colours.set_palette(new_palette, 0.0f);
+    return;
+  }
+  colours.set_palette(new_palette, parent_gui->get_time());
+  start_animating();
+}
+palette const &base::get_palette() const {
+  /// Return the palette this element is drawn with
+  return colours.get_palette();
+}
+void base::set_colour_state(colourset::statetype new_state) {
+  /// Start fading towards the colours for a new state, if we're not already heading there
+  if(colours.transition_to(new_state, parent_gui->get_time())) {
+    start_animating();
+  }
+}
+void base::restart_colour_transition() {
+  /// Fade from the current colours towards those of the current state, for instance after the colours have been changed
+  if(!parent_gui) {
+    return;
+  }
+  colours.restart_transition(parent_gui->get_time());
+  start_animating();
+}
+void base::start_animating() {
+  /// Make sure the gui advances our colour transition each frame until it's complete
+  /// With GUISTORM_GPU_TRANSITIONS the shader does this for us, so only what we're kept drawn in needs telling
+  float const transition_end = parent_gui->get_time() + colours.get_duration(colours.get_state());
+  redraw_pending = true;
+  redraw_until = std::max(redraw_until, transition_end);
+  hold_render_cache(transition_end);
+  #ifndef GUISTORM_GPU_TRANSITIONS
+    if(animating) {
+      return;
+    }
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(parent_gui->animating_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    parent_gui->animating_elements.emplace_back(this);
+    animating = true;
+  #endif // GUISTORM_GPU_TRANSITIONS
 }
 
 #ifndef GUISTORM_NO_TEXT
@@ -290,13 +390,15 @@ void base::set_label(std::string const &newlabel) {
 
 coordtype const base::get_absolute_position() const {
   /// Return the absolute internal coords of the origin of this element (not converted to screen dpi)
-  coordtype parent_origin(0, 0);
-  base *parent_base(dynamic_cast<base*>(parent));
-  if(parent_base) {
-    return position + parent_base->get_absolute_position();                     // obtain its parent position recursively
-  } else {
-    return coordtype(position);                                                 // its parent is not a base type so has no position of its own
+  if(position_absolute_dirty) {
+    if(parent_base) {
+      position_absolute = position + parent_base->get_absolute_position();      // obtain its parent position recursively, only as far as the first cached ancestor
+    } else {
+      position_absolute = position;                                             // its parent is not a base type so has no position of its own
+    }
+    position_absolute_dirty = false;
   }
+  return position_absolute;
 }
 coordtype base::get_position() const {
   /// Return the relative position
@@ -328,17 +430,29 @@ base *base::get_picked(coordtype const &cursor_position) {
   if(!visible) {
     return nullptr;
   }
-  coordtype const &position_absolute(get_absolute_position());
-  if(cursor_position.x >= position_absolute.x &&
-     cursor_position.y >= position_absolute.y &&
-     cursor_position.x <= position_absolute.x + size.x &&
-     cursor_position.y <= position_absolute.y + size.y) {
+  coordtype const origin(get_absolute_position());
+  if(cursor_position.x >= origin.x &&
+     cursor_position.y >= origin.y &&
+     cursor_position.x <= origin.x + size.x &&
+     cursor_position.y <= origin.y + size.y) {
     return this;
   } else {
     mouseover = false;
     return nullptr;
   }
 }
+bool base::is_pick_target() const {
+  /// Return whether picking may return this element itself, rather than only its children
+  return true;
+}
+bool base::clips_picking() const {
+  /// Return whether this element's children can only be picked within its own rect
+  return false;
+}
+container *base::as_container() {
+  /// Return this element's children, if it can have any
+  return nullptr;
+}
 
 std::string const &base::get_label() {
   return label_text;
@@ -362,19 +476,19 @@ void base::update() {
       if(parent_gui->mouse_pressed) {
         active = true;
         on_press();
-        colours.blend_to_active(0.5f);
+        set_colour_state(colourset::statetype::ACTIVE);
       } else {
         if(parent_gui->mouse_released) {
           on_release();
           select_as_input();
         }
-        colours.blend_to_hover(0.5f);
+        set_colour_state(colourset::statetype::HOVER);
       }
     } else {
       if(focused) {
-        colours.blend_to_focus(0.1f);
+        set_colour_state(colourset::statetype::FOCUS);
       } else {
-        colours.blend_to_idle(0.05f);
+        set_colour_state(colourset::statetype::IDLE);
       }
     }
   } else {
@@ -383,8 +497,26 @@ void base::update() {
         select_as_input();
       }
     }
-    colours.blend_to_idle(0.05f);
+    set_colour_state(colourset::statetype::IDLE);
+  }
+}
+void base::update_subtree() {
+  /// Update this element's state without drawing it, as the gui advances each frame
+  if(!visible || culled) {
+    return;
+  }
+  update();
+}
+
+bool base::advance_colours(float time) {
+  /// Move this element's colour transition along to the given gui time
+  /// Returns false once the transition is complete and the element can stop being advanced
+  /// Only called by the gui, with the animating list locked
+  if(colours.advance(time)) {
+    return true;
   }
+  animating = false;                                                            // the gui drops us from its list
+  return false;
 }
 
 void base::on_press() {
@@ -402,64 +534,114 @@ void base::centre_to_gui() {
   set_position((parent_gui->windowsize / 2.0) - (get_size() / 2.0));
 }
 
-void base::init_buffer() {
-  /// Generate the buffers for this object
-  glGenBuffers(1, &vbo);
-  glGenBuffers(1, &ibo);
-  glGenBuffers(1, &vbo_label);
-  glGenBuffers(1, &ibo_label);
+void base::invalidate(unsigned char flags) {
+  /// Mark parts of this element as needing a rebuild, which is deferred until the start of the next frame
+  /// However many times this is called, the element is only queued and rebuilt once
+  if(!parent_gui) {
+    dirty |= flags;
+    return;
+  }
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(parent_gui->dirty_elements_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  if(dirty == 0) {
+    parent_gui->dirty_elements.emplace_back(this);                              // only queue once
+  }
+  dirty |= flags;
+}
+void base::update_dirty() {
+  /// Carry out whatever deferred rebuilds this element has been marked as needing
+  #if defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_TEXT)
+    unsigned int const font_atlas_generation = parent_gui->font_atlas_generation; // to notice the atlas growing while our label's arranged
+  #endif // defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_TEXT)
+  if(dirty & dirty_layout) {
+    update_layout();                                                            // this may add further flags, but won't queue us again while we're still dirty
+  }
+  if(is_culled()) {
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(parent_gui->dirty_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    dirty &= dirty_geometry | dirty_label;                                      // nothing to see, so only rebuild when we're next drawn, if ever
+    return;
+  }
+  #ifndef GUISTORM_NO_TEXT
+    if(dirty & dirty_label) {
+      #ifndef GUISTORM_SINGLETHREADED
+        std::unique_lock lock_label_lines(label_lines_mutex);                   // lock for writing (unique)
+      #endif // GUISTORM_SINGLETHREADED
+      label_lines.clear();                                                      // force the label to be re-arranged by setup_label
+    }
+  #endif // GUISTORM_NO_TEXT
+  if(dirty & (dirty_geometry | dirty_label)) {
+    setup_buffer();
+    ++parent_gui->stats.elements_rebuilt;
+  }
+  invalidate_appearance();                                                      // whatever changed has to be redrawn
+  {
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(parent_gui->dirty_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    dirty = 0;                                                                  // cleared last, so anything invalidated while rebuilding is covered by this rebuild
+  }
+  #if defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_TEXT)
+    if(parent_gui->font_atlas_generation != font_atlas_generation) {
+      invalidate(dirty_label);                                                  // some of our glyphs were placed against the atlas at its old size, so go again
+    }
+  #endif // defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_TEXT)
+}
+
+void base::invalidate_appearance() {
+  /// Note that we look different, so have to be redrawn wherever we're kept drawn between
+  /// frames: our area of the gui's layer, and any cached windows we're in
+  redraw_pending = true;
+  invalidate_render_cache();
+}
+void base::damage_drawn() {
+  /// Add wherever we were last drawn to the gui's damage region, as we won't be drawn there again
+  if(!drawn) {
+    return;
+  }
+  parent_gui->add_damage(drawn_position, drawn_position + drawn_size);
+  drawn = false;
+}
+void base::invalidate_render_cache() {
+  /// Make any cached window we're part of redraw its texture before it's next composited
+  if(parent_base) {
+    parent_base->invalidate_render_cache();                                     // an outer cache holds a copy of any inner one, so every cache upwards is affected
+  } else if(parent_gui) {
+    parent_gui->request_redraw();                                               // and at the top, the gui has to draw again
+  }
+}
+void base::restyle() {
+  /// Pick up changes to a shared palette - we draw from it directly, so only cached windows need telling
+}
+void base::hold_render_cache(float until) {
+  /// Make any cached window we're part of redraw every frame until the given gui time, while our colours are changing
+  if(parent_base) {
+    parent_base->hold_render_cache(until);
+  } else if(parent_gui) {
+    parent_gui->request_redraw_until(until);
+  }
 }
+
 void base::destroy_buffer() {
-  /// Clean up the buffers in preparation for exit or context switch
-  glDeleteBuffers(1, &vbo);
-  glDeleteBuffers(1, &ibo);
-  glDeleteBuffers(1, &vbo_label);
-  glDeleteBuffers(1, &ibo_label);
-  vbo = 0;
-  ibo = 0;
-  vbo_label = 0;
-  ibo_label = 0;
-  numverts = 0;
-  numverts_label = 0;
-  initialised = false;
+  /// Clean up the cached geometry in preparation for exit or context switch
+  #ifndef GUISTORM_NO_TEXT
+    label_glyph_quads.clear();
+  #endif // GUISTORM_NO_TEXT
+  invalidate(dirty_geometry);
 }
 void base::setup_buffer() {
-  /// Create or update the buffer for this element
-  if(__builtin_expect(vbo == 0, 0)) {                                           // if the buffer hasn't been generated yet (unlikely)
-    init_buffer();
-  }
-
-  coordtype const position_absolute(get_absolute_position());
-  std::vector<vertex> vbodata;
-  vbodata.reserve(4);
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(position_absolute.x         , position_absolute.y         )));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(position_absolute.x + size.x, position_absolute.y         )));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(position_absolute.x + size.x, position_absolute.y + size.y)));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(position_absolute.x         , position_absolute.y + size.y)));
-  std::vector<GLuint> ibodata{0, 1, 2, 3};
-  numverts = 4;
-
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-  glBufferData(GL_ARRAY_BUFFER,         vbodata.size() * sizeof(vertex), &vbodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-  #endif // GUISTORM_UNBIND
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, numverts       * sizeof(GLuint), &ibodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  #endif // GUISTORM_UNBIND
-
+  /// Create or update the cached geometry for this element, relative to its origin
   #ifndef GUISTORM_NO_TEXT
     setup_label();                                                              // set up the label buffer
   #endif
-
-  initialised = true;
 }
 
 #ifndef GUISTORM_NO_TEXT
 void base::arrange_label() {
   /// Called by setup_label, but can be called manually to just update text.
+  ++parent_gui->stats.labels_arranged;
   font &this_label_font(get_label_font());
   // compose the text layout in the abstract first
   label_glyphs = 0;                                                             // reset the glyph count
@@ -603,7 +785,7 @@ void base::arrange_label() {
 
 void base::update_label_alignment() {
   /// decide on label positioning and reshuffle the layout for justifications
-  coordtype const label_position(get_absolute_position());
+  coordtype const label_position(0, 0);                                         // the label is arranged relative to this element's origin
   switch(label_alignment) {                                                     // horizontal
   case aligntype::CENTRE:
   case aligntype::TOP:
@@ -659,7 +841,8 @@ void base::update_label_alignment() {
 }
 
 void base::setup_label() {
-  /// Upload just the label portion of the buffer
+  /// Regenerate just the label portion of the cached geometry
+  ++parent_gui->stats.labels_setup;
   #ifndef GUISTORM_SINGLETHREADED
     std::shared_lock lock_label_lines(label_lines_mutex);                       // lock for reading (shared)
   #endif // GUISTORM_SINGLETHREADED
@@ -674,21 +857,15 @@ void base::setup_label() {
   }
   update_label_alignment();                                                     // update position in all cases
 
-  // compose the VBO from the text positioning
-  std::vector<vertex> vbodata;
-  std::vector<GLuint> ibodata;
+  // compose the glyph quads from the text positioning
   coordtype pen(label_origin);
   #ifdef GUISTORM_NO_UTF
     char charcode_last = '\0';
   #else
     char32_t charcode_last = U'\0';
   #endif // GUISTORM_NO_UTF
-  vbodata.reserve(label_glyphs * 4);
-  #ifdef GUISTORM_AVOIDQUADS
-    ibodata.reserve(label_glyphs + 6);
-  #else
-    ibodata.reserve(label_glyphs + 4);
-  #endif // GUISTORM_AVOIDQUADS
+  label_glyph_quads.clear();
+  label_glyph_quads.reserve(label_glyphs);
   for(auto const &thisline : label_lines) {
     for(auto const &thisword : thisline.words) {
       for(auto const &thisglyph : thisword.glyphs) {
@@ -701,20 +878,7 @@ void base::setup_label() {
           #else
             coordtype const corner0(pen + thisglyph->offset);
           #endif // GUISTORM_ROUND_NEAREST_ALL
-          coordtype const corner1(corner0 + thisglyph->size);
-          unsigned int ibo_offset = cast_if_required<GLuint>(vbodata.size());
-          vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner0.x, corner0.y)), coordtype(thisglyph->texcoord0.x, thisglyph->texcoord0.y));
-          vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner1.x, corner0.y)), coordtype(thisglyph->texcoord1.x, thisglyph->texcoord0.y));
-          vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner1.x, corner1.y)), coordtype(thisglyph->texcoord1.x, thisglyph->texcoord1.y));
-          vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner0.x, corner1.y)), coordtype(thisglyph->texcoord0.x, thisglyph->texcoord1.y));
-          ibodata.emplace_back(ibo_offset + 0);
-          ibodata.emplace_back(ibo_offset + 1);
-          ibodata.emplace_back(ibo_offset + 2);
-          #ifdef GUISTORM_AVOIDQUADS
-            ibodata.emplace_back(ibo_offset + 0);                               // doing this as indexed triangles instead of deprecated quads costs 50% more index entries
-            ibodata.emplace_back(ibo_offset + 2);
-          #endif // GUISTORM_AVOIDQUADS
-          ibodata.emplace_back(ibo_offset + 3);
+          label_glyph_quads.emplace_back(corner0, corner0 + thisglyph->size, thisglyph->texcoord0, thisglyph->texcoord1);
         }
         pen += thisglyph->advance;
       }
@@ -723,37 +887,10 @@ void base::setup_label() {
     pen.x = label_origin.x;                                                     // carriage return
     pen.y -= label_line_spacing;                                                // line feed
   }
+  parent_gui->stats.glyph_quads += cast_if_required<unsigned int>(label_glyph_quads.size());
   #ifndef GUISTORM_SINGLETHREADED
     lock_label_lines.unlock();
   #endif // GUISTORM_SINGLETHREADED
-  numverts_label = cast_if_required<GLuint>(ibodata.size());
-
-  #ifdef DEBUG_GUISTORM
-    /*
-    std::cout << "GUIStorm: Uploading " << vbodata.size() << " " << sizeof(vertex) << "B verts, " << numverts_label << " indices to vbo ("
-              << (vbodata.size() * sizeof(vertex)) << "B, "
-              << (numverts_label * sizeof(GLuint)) << "B) "
-              << "atlas " << parent_gui->font_atlas->id() << std::endl;
-    */
-  #endif // DEBUG_GUISTORM
-
-  if(ibodata.empty() || vbodata.empty()) {
-    //#ifdef DEBUG_GUISTORM
-      std::cout << "GUIStorm: DEBUG: not uploading empty buffer" << std::endl;
-    //#endif // DEBUG_GUISTORM
-    return;
-  }
-
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo_label);
-  glBufferData(GL_ARRAY_BUFFER,         vbodata.size() * sizeof(vertex), &vbodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-  #endif // GUISTORM_UNBIND
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_label);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, numverts_label * sizeof(GLuint), &ibodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  #endif // GUISTORM_UNBIND
 }
 #endif // GUISTORM_NO_TEXT
 
@@ -765,81 +902,124 @@ void base::update_layout() {
   for(auto const &thisrule : layout_rules) {
     thisrule();
   }
+  parent_gui->stats.layout_rules_run += cast_if_required<unsigned int>(layout_rules.size());
   if(!layout_rules.empty()) {
     refresh_position_only();
   }
 }
 
 void base::refresh() {
-  /// Refresh this object's visual state
-  #ifndef GUISTORM_NO_TEXT
-    #ifndef GUISTORM_SINGLETHREADED
-      std::unique_lock lock_label_lines(label_lines_mutex);                     // lock for writing (unique)
-    #endif // GUISTORM_SINGLETHREADED
-    label_lines.clear();                                                        // ensure the label buffer arrangement also gets refreshed
-    #ifndef GUISTORM_SINGLETHREADED
-      lock_label_lines.unlock();
-    #endif // GUISTORM_SINGLETHREADED
-  #endif // GUISTORM_NO_TEXT
-  refresh_position_only();                                                      // refresh the outline shape
+  /// Refresh this object's visual state, including re-arranging the label, before the next frame
+  invalidate(dirty_geometry | dirty_label);
 }
 
 void base::refresh_position_only() {
-  /// Refresh this object's position and size only, don't refresh text content
-  initialised = false;
+  /// Refresh this object's size-dependent geometry only, don't refresh text content - moving alone needs no refresh
+  invalidate(dirty_geometry);
+  reindex_picking();
 }
-
-void base::render() {
-  /// Draw this element
-  if(!visible) {
-    return;
+void base::reindex_picking() {
+  /// Let the gui's picking index know this element and its children have moved, resized or changed visibility
+  #ifdef GUISTORM_PICK_GRID
+    if(parent_gui) {
+      parent_gui->pick_index.invalidate(this);
+    }
+  #endif // GUISTORM_PICK_GRID
+}
+void base::invalidate_absolute_position() {
+  /// Discard the cached absolute position of this element and all its children, after it's moved or been reparented
+  if(position_absolute_dirty) {
+    return;                                                                     // if we're already dirty, so is everything below us
   }
-  if(__builtin_expect(!initialised, 0)) {                                       // if the buffer hasn't been initialised yet (unlikely)
-    setup_buffer();
+  position_absolute_dirty = true;
+  container *children = as_container();
+  if(children) {
+    for(auto const &child : children->elements) {
+      child->invalidate_absolute_position();
+    }
+  }
+}
+
+bool base::is_clipping_children() const {
+  /// Return whether anything inside us is clipped to our bounds - only windows can clip their contents
+  return false;
+}
+bool base::is_culled() const {
+  /// Return whether we, or anything clipping us, were skipped as entirely outside the visible area when last drawn
+  /// A culled ancestor that doesn't clip still draws its children, so only those that clip hide us too
+  if(culled) {
+    return true;
   }
-  if(numverts != 0) {
-    glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-    glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-
-    if(colours.current.background.a != 0.0f) {                                  // skip drawing fully transparent parts
-      glUniform4f(parent_gui->uniform_colour,
-                  colours.current.background.r,
-                  colours.current.background.g,
-                  colours.current.background.b,
-                  colours.current.background.a);
-      glDrawElements(GL_TRIANGLE_FAN, numverts, GL_UNSIGNED_INT, 0);            // background
+  for(base const *ancestor = parent_base; ancestor; ancestor = ancestor->parent_base) {
+    if(ancestor->culled && ancestor->is_clipping_children()) {
+      return true;
     }
-    if(colours.current.outline.a != 0.0f) {                                     // skip drawing fully transparent parts
-      glUniform4f(parent_gui->uniform_colour,
-                  colours.current.outline.r,
-                  colours.current.outline.g,
-                  colours.current.outline.b,
-                  colours.current.outline.a);
-      glDrawElements(GL_LINE_LOOP,    numverts, GL_UNSIGNED_INT, 0);            // outline
+  }
+  return false;
+}
+bool base::cull(coordtype const &origin) {
+  /// Skip drawing if we're entirely outside the clip rect, returning true if so
+  /// Called as we're drawn; rebuilds put off while we were culled are carried out as soon as we can be seen again
+  return cull(origin, origin + size);                                           // most elements draw within their own bounds
+}
+bool base::cull(coordtype const &lower, coordtype const &upper) {
+  /// Skip drawing if the area we draw in is entirely outside the clip rect, returning true if so
+  /// For elements that draw outside their own bounds, such as lines reaching either side of their origin
+  if(parent_gui->current_batch->is_clipped_out(lower, upper)) {
+    if(!culled) {
+      damage_drawn();                                                           // wherever we were is uncovered
+      culled = true;
     }
+    ++parent_gui->stats.elements_culled;
+    return true;
   }
-  // draw the label
-  if(numverts_label != 0) {
-    glBindBuffer(GL_ARRAY_BUFFER,         vbo_label);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_label);
-    glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-    glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-
-    glUniform4f(parent_gui->uniform_colour,
-                colours.current.content.r,
-                colours.current.content.g,
-                colours.current.content.b,
-                colours.current.content.a);
-    #ifdef GUISTORM_AVOIDQUADS
-      glDrawElements(GL_TRIANGLES, numverts_label, GL_UNSIGNED_INT, 0);
-    #else
-      glDrawElements(GL_QUADS, numverts_label, GL_UNSIGNED_INT, 0);
-    #endif // GUISTORM_AVOIDQUADS
+  culled = false;
+  if(dirty != 0) {
+    update_dirty();                                                             // catch up on whatever we skipped
+  }
+  return false;
+}
+void base::track_damage(coordtype const &origin) {
+  /// Add whatever has changed about us since we were last drawn to the gui's damage region
+  /// Called as we're drawn - elements are assumed to draw within their own bounds
+  track_damage(origin, origin + size);
+}
+void base::track_damage(coordtype const &lower, coordtype const &upper) {
+  /// Add whatever has changed about the area we draw in since we were last drawn to the gui's damage region
+  /// For elements that draw outside their own bounds, such as lines reaching either side of their origin
+  coordtype const area_size(upper - lower);
+  if(drawn && (lower != drawn_position || area_size != drawn_size)) {
+    parent_gui->add_damage(drawn_position, drawn_position + drawn_size);        // where we were
+    redraw_pending = true;
   }
+  if(redraw_pending || !drawn) {
+    parent_gui->add_damage(lower, upper);                                       // where we are
+  }
+  drawn_position = lower;
+  drawn_size     = area_size;
+  drawn          = true;
+  redraw_pending = parent_gui->get_time() < redraw_until;                       // kept while our colours are changing, to redraw once more after they end
+}
 
-  update();
+void base::render() {
+  /// Submit this element's geometry to the gui's batch renderer
+  if(!visible) {
+    return;
+  }
+  batch &render_batch = *parent_gui->current_batch;
+  coordtype const origin(get_absolute_position());                              // all cached geometry is relative to this
+  if(cull(origin)) {
+    return;
+  }
+  track_damage(origin);
+  if(draw_shape) {
+    coordtype const corner(origin + size);
+    render_batch.add_rect(   origin, corner, colours.get_paint_background());   // background
+    render_batch.add_outline(origin, corner, colours.get_paint_outline());      // outline
+  }
+  #ifndef GUISTORM_NO_TEXT
+    render_batch.add_glyphs(label_glyph_quads, origin, colours.get_paint_content()); // label
+  #endif // GUISTORM_NO_TEXT
 }
 
 }
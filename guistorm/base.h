@@ -5,9 +5,11 @@
   #include <shared_mutex>
 #endif // GUISTORM_SINGLETHREADED
 #include "types.h"
+#include "batch.h"
 #include "colourset.h"
 #include "font.h"
 #include "layout_rules.h"
+#include "pick_grid.h"
 
 namespace guistorm {
 
@@ -16,46 +18,59 @@ class container;
 
 class base {
   friend class container;                                                       // needed to allow deletion by container
+  #ifdef GUISTORM_PICK_GRID
+    friend class pick_grid;
+  #endif // GUISTORM_PICK_GRID
 protected:
-  // OpenGL rendering
-  struct vertex {
-    coordtype coords;
-    coordtype texcoords;
-    vertex(coordtype const &new_coords,
-           coordtype const &new_texcoords = coordtype(1.0, 1.0))
-    : coords(new_coords),
-      texcoords(new_texcoords) {
-      /// Specific constructor
-    }
-  };
-  GLuint vbo            = 0;                                                    // vertex buffer, in format compatible with both GL_LINE_LOOP and GL_TRIANGLE_FAN
-  GLuint ibo            = 0;                                                    // index buffer
-  GLuint vbo_label      = 0;                                                    // vertex buffer for label text in GL_QUADS format
-  GLuint ibo_label      = 0;                                                    // index buffer for label text
-  GLuint numverts       = 0;                                                    // number of vertices to render for the main shape
-  GLuint numverts_label = 0;                                                    // number of vertices to render for the label
-  //GLuint font_atlas_id  = 0;                                                    // font atlas ID for this label
+  // rendering
+  using vertex     = batch::vertex;
+  using glyph_quad = batch::glyph_quad;
+  bool draw_shape = true;                                                       // whether to draw the background and outline shape, or only the label
+  #ifndef GUISTORM_NO_TEXT
+    std::vector<glyph_quad> label_glyph_quads;                                  // cached glyphs of the label in pixels relative to the origin, one rect each
+  #endif // GUISTORM_NO_TEXT
 
 public:
   // relations
   gui *parent_gui   = nullptr;                                                  // the top level gui this entity is rendered as a part of
   container *parent = nullptr;                                                  // the container this object belongs to
+  base *parent_base = nullptr;                                                  // the same parent as an element, or nullptr if it's the gui itself
 
 protected:
   // state
   bool visible     = true;                                                      // whether to render this element
-  bool initialised = false;                                                     // whether the buffer is populated and it's ready to be rendered
+  unsigned char dirty = 0;                                                      // which parts of this element need rebuilding before it's next drawn, see dirty_* flags
 public:
   bool focusable = false;                                                       // whether it can be given focus
   bool focused   = false;                                                       // true recursively for all windows upwards from the currently focused widget or window
 protected:
   bool mouseover = false;                                                       // only works on focusable items
   bool active    = false;                                                       // clicked - only true while clicking / typing / dragging
+  bool animating = false;                                                       // whether we're on the gui's list of elements with colour transitions in progress
+  // damage tracking
+  coordtype drawn_position;                                                     // where we were last drawn in window pixels, to know what to redraw when we change
+  coordtype drawn_size;
+  bool drawn = false;                                                           // whether we've been drawn since we were last hidden
+  bool redraw_pending = true;                                                   // whether we look different from when we were last drawn
+  float redraw_until = 0.0f;                                                    // gui time to keep redrawing us every frame until, while our colours are changing
+  bool culled = false;                                                          // whether we were last found entirely outside the visible area, so skipped along with anything inside us
+  #ifdef GUISTORM_PICK_GRID
+    pick_grid::membership pick_membership;                                      // where this element sits in the gui's picking index
+  #endif // GUISTORM_PICK_GRID
+
+public:
+  // invalidation flags
+  static unsigned char constexpr dirty_geometry = 1 << 0;                       // cached geometry needs rebuilding, e.g. after a resize
+  static unsigned char constexpr dirty_label    = 1 << 1;                       // label needs re-arranging from its text
+  static unsigned char constexpr dirty_layout   = 1 << 2;                       // layout rules need re-applying
 
 protected:
   // positions
   coordtype position;                                                           // the relative coordinates of this to its parent
   coordtype size;                                                               // the distance of the furthest corner
+private:
+  mutable coordtype position_absolute;                                          // cached absolute position, valid unless position_absolute_dirty
+  mutable bool position_absolute_dirty = true;                                  // whether this or any ancestor has moved since position_absolute was cached
 
 public:
   // colours
@@ -135,6 +150,13 @@ public:
   void set_colour_hover(  colourtype const &background, colourtype const &outline, colourtype const &content);
   void set_colour_focus(  colourtype const &background, colourtype const &outline, colourtype const &content);
   void set_colour_active( colourtype const &background, colourtype const &outline, colourtype const &content);
+  void set_palette(std::shared_ptr<palette const> const &new_palette);
+  palette const &get_palette() const __attribute__((__pure__));
+  void set_colour_state(colourset::statetype new_state);
+  void restart_colour_transition();
+protected:
+  void start_animating();
+public:
   #ifndef GUISTORM_NO_TEXT
     font &get_label_font();
   #endif // GUISTORM_NO_TEXT
@@ -149,6 +171,9 @@ public:
   bool const &is_visible() const __attribute__((__const__));
   bool const &is_active() const __attribute__((__const__));
   virtual base *get_picked(coordtype const &cursor_position);
+  virtual bool is_pick_target() const;
+  virtual bool clips_picking() const __attribute__((__const__));
+  virtual container *as_container() __attribute__((__const__));
   std::string const &get_label() __attribute__((__const__));
   template<typename T, class ...Args> void add_layout_rule(T thisrule, Args &&...args);
 
@@ -157,12 +182,20 @@ public:
 
   // updating
   virtual void update();
+  virtual void update_subtree();
+  bool advance_colours(float delta_time);
   virtual void on_press();
   virtual void on_release();
   void centre_to_gui();
 
   // rendering
-  virtual void init_buffer();
+  void invalidate(unsigned char flags);
+  void update_dirty();
+  void invalidate_appearance();
+  virtual void damage_drawn();
+  virtual void invalidate_render_cache();
+  virtual void restyle();
+  virtual void hold_render_cache(float until);
   virtual void destroy_buffer();
 protected:
   virtual void setup_buffer();
@@ -179,7 +212,18 @@ public:
   virtual void update_layout();
   virtual void refresh();
   void refresh_position_only();
+  void reindex_picking();
+  void invalidate_absolute_position();
+
+  virtual bool is_clipping_children() const __attribute__((__pure__));
+  bool is_culled() const __attribute__((__pure__));
 
+protected:
+  bool cull(coordtype const &origin);
+  bool cull(coordtype const &lower, coordtype const &upper);
+  void track_damage(coordtype const &origin);
+  void track_damage(coordtype const &lower, coordtype const &upper);
+public:
   virtual void render();
 };
 
@@ -189,6 +233,7 @@ template<typename T, class ...Args> void base::add_layout_rule(T thisrule, Args
   //layout_rules.emplace_back(std::bind(thisrule, *this, args...));
   //layout_rules.emplace_back(std::bind(thisrule, *this, std::forward<Args>(args)...));
   layout_rules.emplace_back([thisrule, this, args...](){thisrule(*this, args...);});
+  invalidate(dirty_layout);                                                     // apply the new rule before the next frame
   // the following references are not safe to use here:
   //layout_rules.emplace_back([thisrule, this, &args...](){thisrule(*this, args...);});
   //layout_rules.emplace_back([&thisrule, this, &args...](){thisrule(*this, std::forward<Args>(args)...);});
@@ -0,0 +1,617 @@
+#include "batch.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "cast_if_required.h"
+#include "gui.h"
+#include "rounding.h"
+
+namespace guistorm {
+
+batch::batch(gui &new_parent_gui)
+  : parent_gui(new_parent_gui) {
+  /// Specific constructor
+}
+
+batch::~batch() {
+  /// Default destructor
+}
+
+void batch::init_buffer() {
+  /// Generate the stream buffers
+  if(vbo != 0) {
+    return;                                                                     // already initialised
+  }
+  vbo = parent_gui.render_backend->gen_buffer();
+  ibo = parent_gui.render_backend->gen_buffer();
+  ibo_quads = 0;
+  if(parent_gui.render_backend->has_vertex_arrays()) {
+    vao = parent_gui.render_backend->gen_vertex_array();
+  }
+  vao_ready = false;
+  pointers_set = false;
+  #ifdef GUISTORM_INSTANCED_QUADS
+    instanced = parent_gui.render_backend->has_instancing();
+    if(!instanced) {
+      std::cout << "GUIStorm: instanced drawing is not available, expanding quads into vertices instead" << std::endl;
+      return;
+    }
+    // the unit square every instance is drawn from, uploaded once
+    static coordtype const quad_corners[4]{coordtype(0.0f, 0.0f), coordtype(1.0f, 0.0f), coordtype(1.0f, 1.0f), coordtype(0.0f, 1.0f)};
+    quad_vbo = parent_gui.render_backend->gen_buffer();
+    parent_gui.render_backend->bind_buffer(GL_ARRAY_BUFFER, quad_vbo);
+    parent_gui.render_backend->buffer_data(GL_ARRAY_BUFFER, sizeof(quad_corners), quad_corners, GL_STATIC_DRAW);
+    reserve_quad_indices(1);                                                    // instances only ever use the first quad's indices
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+void batch::destroy_buffer() {
+  /// Clean up the stream buffers in preparation for exit or context switch
+  parent_gui.render_backend->delete_buffer(vbo);
+  parent_gui.render_backend->delete_buffer(ibo);
+  vbo = 0;
+  ibo = 0;
+  if(vao != 0) {
+    parent_gui.render_backend->delete_vertex_array(vao);
+    vao = 0;
+  }
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(quad_vbo != 0) {
+      parent_gui.render_backend->delete_buffer(quad_vbo);
+      quad_vbo = 0;
+    }
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+
+void batch::clear() {
+  /// Empty the batch ready to collect a new frame, keeping allocations for reuse
+  vertices.clear();
+  texture_runs.clear();
+  clip_corner0 = coordtype(std::numeric_limits<coordcomponent>::lowest(), std::numeric_limits<coordcomponent>::lowest()); // unclipped until told otherwise
+  clip_corner1 = coordtype(std::numeric_limits<coordcomponent>::max(),    std::numeric_limits<coordcomponent>::max());
+  #ifdef GUISTORM_INSTANCED_QUADS
+    instances.clear();
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+
+void batch::add_rect(coordtype const &corner0, coordtype const &corner1, paint const &colour) {
+  /// Add a solid axis-aligned rectangle
+  if(is_transparent(colour)) {
+    return;                                                                     // skip drawing fully transparent parts
+  }
+  push_rect(corner0, corner1, colour);
+}
+
+void batch::add_outline(coordtype const &corner0, coordtype const &corner1, paint const &colour) {
+  /// Add the outline of an axis-aligned rectangle, drawn as four thin quads just inside its edges
+  if(is_transparent(colour)) {
+    return;                                                                     // skip drawing fully transparent parts
+  }
+  push_rect(coordtype(corner0.x,              corner0.y             ), coordtype(corner1.x,              corner0.y + line_width), colour); // bottom
+  push_rect(coordtype(corner0.x,              corner1.y - line_width), coordtype(corner1.x,              corner1.y             ), colour); // top
+  push_rect(coordtype(corner0.x,              corner0.y + line_width), coordtype(corner0.x + line_width, corner1.y - line_width), colour); // left
+  push_rect(coordtype(corner1.x - line_width, corner0.y + line_width), coordtype(corner1.x,              corner1.y - line_width), colour); // right
+}
+
+void batch::add_line(coordtype const &start, coordtype const &end, paint const &colour) {
+  /// Add a single line segment
+  if(is_transparent(colour)) {
+    return;                                                                     // skip drawing fully transparent parts
+  }
+  push_line(start, end, colour);
+}
+
+void batch::add_line_strip(std::vector<coordtype> const &points, coordtype const &offset, paint const &colour) {
+  /// Add a continuous line joining each point to the next, shifted by an offset
+  if(is_transparent(colour) || points.size() < 2) {
+    return;                                                                     // skip drawing fully transparent or empty lines
+  }
+  for(auto it = points.begin() + 1; it != points.end(); ++it) {
+    push_line(*(it - 1) + offset, *it + offset, colour);
+  }
+}
+
+void batch::add_lines(std::vector<vertex> const &points,
+                      std::vector<GLuint> const &pairs,
+                      coordtype const &offset,
+                      paint const &colour) {
+  /// Add a set of indexed line segments, each a pair of indices into the points, shifted by an offset
+  if(is_transparent(colour) || points.empty() || pairs.size() < 2) {
+    return;                                                                     // skip drawing fully transparent or empty shapes
+  }
+  for(size_t i = 0; i + 1 < pairs.size(); i += 2) {
+    push_line(points[pairs[i]].coords + offset, points[pairs[i + 1]].coords + offset, colour);
+  }
+}
+
+void batch::add_glyphs(std::vector<glyph_quad> const &glyphs, coordtype const &offset, paint const &colour) {
+  /// Add the glyphs of a label, shifted by an offset
+  if(is_transparent(colour) || glyphs.empty()) {
+    return;                                                                     // skip drawing fully transparent or empty labels
+  }
+  for(auto const &thisglyph : glyphs) {
+    push_textured_rect(thisglyph.corner0 + offset, thisglyph.corner1 + offset, thisglyph.texcoord0, thisglyph.texcoord1, colour);
+  }
+}
+
+void batch::add_texture(coordtype const &corner0, coordtype const &corner1, GLuint texture, paint const &colour) {
+  /// Add an axis-aligned rectangle showing the whole of a texture of its own, such as a cached window
+  if(is_transparent(colour)) {
+    return;                                                                     // skip drawing fully transparent parts
+  }
+  set_texture(texture);
+  push_textured_rect(corner0, corner1, coordtype(0.0f, 0.0f), coordtype(1.0f, 1.0f), colour);
+  set_texture(0);                                                               // whatever comes next samples the usual texture again
+}
+
+void batch::set_clip(coordtype const &corner0, coordtype const &corner1) {
+  /// Clip everything added from now on to this rect, in window pixels, replacing any clip rect so far
+  clip_corner0 = corner0;
+  clip_corner1 = corner1;
+}
+void batch::intersect_clip(coordtype const &corner0, coordtype const &corner1) {
+  /// Clip everything added from now on to this rect as well as the current clip rect, in any orientation
+  clip_corner0.x = std::max(clip_corner0.x, std::min(corner0.x, corner1.x));
+  clip_corner0.y = std::max(clip_corner0.y, std::min(corner0.y, corner1.y));
+  clip_corner1.x = std::min(clip_corner1.x, std::max(corner0.x, corner1.x));
+  clip_corner1.y = std::min(clip_corner1.y, std::max(corner0.y, corner1.y));
+}
+coordtype const &batch::get_clip_corner0() const {
+  /// Return the lower left corner of the current clip rect, for restoring it later
+  return clip_corner0;
+}
+coordtype const &batch::get_clip_corner1() const {
+  /// Return the upper right corner of the current clip rect, for restoring it later
+  return clip_corner1;
+}
+bool batch::is_clipped_out(coordtype const &corner0, coordtype const &corner1) const {
+  /// Return whether a rect, in any orientation, lies entirely outside the current clip rect, so nothing within it can be seen
+  return std::max(corner0.x, corner1.x) < clip_corner0.x ||
+         std::max(corner0.y, corner1.y) < clip_corner0.y ||
+         std::min(corner0.x, corner1.x) > clip_corner1.x ||
+         std::min(corner0.y, corner1.y) > clip_corner1.y ||
+         clip_corner1.x < clip_corner0.x ||                                     // nested clip rects that don't overlap leave nothing
+         clip_corner1.y < clip_corner0.y;
+}
+
+bool batch::is_transparent(paint const &colour) {
+  /// Return whether anything drawn in this colour would be invisible throughout
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    return colour.is_transparent();
+  #else
+    return colour.a == 0.0f;
+  #endif // GUISTORM_GPU_TRANSITIONS
+}
+
+void batch::clip_span(coordcomponent &corner0,
+                      coordcomponent &corner1,
+                      coordcomponent &texcoord0,
+                      coordcomponent &texcoord1,
+                      coordcomponent lower,
+                      coordcomponent upper) {
+  /// Clip one axis of a textured rect to the span from lower to upper, moving each texcoord along with its edge
+  coordcomponent const span = corner1 - corner0;
+  if(span == 0) {
+    return;                                                                     // nothing to clip, or to interpolate across
+  }
+  coordcomponent const texcoord_span = texcoord1 - texcoord0;
+  coordcomponent const clipped0 = std::clamp(corner0, lower, upper);
+  coordcomponent const clipped1 = std::clamp(corner1, lower, upper);
+  coordcomponent const texcoord_start = texcoord0;
+  coordcomponent const corner_start = corner0;
+  if(clipped0 != corner0) {                                                     // edges left unclipped keep their exact texcoords
+    texcoord0 = texcoord_start + texcoord_span * ((clipped0 - corner_start) / span);
+    corner0 = clipped0;
+  }
+  if(clipped1 != corner1) {
+    texcoord1 = texcoord_start + texcoord_span * ((clipped1 - corner_start) / span);
+    corner1 = clipped1;
+  }
+}
+
+void batch::push_quad(vertex const &v0,
+                      vertex const &v1,
+                      #ifdef GUISTORM_INSTANCED_QUADS
+                        vertex const &v2 [[maybe_unused]],
+                      #else
+                        vertex const &v2,
+                      #endif // GUISTORM_INSTANCED_QUADS
+                      vertex const &v3,
+                      paint const &colour) {
+  /// Append a quad to the streams in window pixels, tinted with the specified colour
+  #ifdef GUISTORM_ROUND_NEAREST_OUT
+    vertex const r0(coordtype(GUISTORM_ROUND(v0.coords.x), GUISTORM_ROUND(v0.coords.y)), v0.texcoords, colour);
+    vertex const r1(coordtype(GUISTORM_ROUND(v1.coords.x), GUISTORM_ROUND(v1.coords.y)), v1.texcoords, colour);
+    vertex const r3(coordtype(GUISTORM_ROUND(v3.coords.x), GUISTORM_ROUND(v3.coords.y)), v3.texcoords, colour);
+  #else
+    vertex const r0(v0.coords, v0.texcoords, colour);
+    vertex const r1(v1.coords, v1.texcoords, colour);
+    vertex const r3(v3.coords, v3.texcoords, colour);
+  #endif // GUISTORM_ROUND_NEAREST_OUT
+  #ifdef GUISTORM_INSTANCED_QUADS
+    instances.emplace_back(r0, r1, r3, colour);                                 // the fourth corner follows from the other three
+  #else
+    #ifdef GUISTORM_ROUND_NEAREST_OUT
+      vertex const r2(coordtype(GUISTORM_ROUND(v2.coords.x), GUISTORM_ROUND(v2.coords.y)), v2.texcoords, colour);
+    #else
+      vertex const r2(v2.coords, v2.texcoords, colour);
+    #endif // GUISTORM_ROUND_NEAREST_OUT
+    append_quad(r0, r1, r2, r3);
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+
+void batch::append_quad(vertex const &v0, vertex const &v1, vertex const &v2, vertex const &v3) {
+  /// Append the vertices of a finished quad to the stream - its indices are already in the shared index buffer
+  vertices.emplace_back(v0);
+  vertices.emplace_back(v1);
+  vertices.emplace_back(v2);
+  vertices.emplace_back(v3);
+}
+
+void batch::set_texture(GLuint texture) {
+  /// Make the quads added from now on sample the given texture, or the one the batch is rendered with if 0
+  if(texture_runs.empty()) {
+    if(texture == 0) {
+      return;                                                                   // no quads have changed texture yet
+    }
+    texture_runs.emplace_back(0, 0);                                            // everything so far samples the usual texture
+  }
+  if(texture_runs.back().texture != texture) {
+    texture_runs.emplace_back(texture, get_quad_count());
+  }
+}
+unsigned int batch::get_quad_count() const {
+  /// Return how many quads have been added so far this frame
+  #ifdef GUISTORM_INSTANCED_QUADS
+    return cast_if_required<unsigned int>(instances.size());
+  #else
+    return cast_if_required<unsigned int>(vertices.size() / 4);
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+
+void batch::reserve_quad_indices(unsigned int quads) {
+  /// Make sure the shared index buffer covers at least this many quads, regrowing it if not
+  if(quads <= ibo_quads) {
+    return;
+  }
+  quads = std::min(std::max(quads, ibo_quads * 2), max_quads_per_draw);         // grow geometrically so a slowly growing gui doesn't reupload every frame
+  std::vector<GLushort> quad_indices;
+  quad_indices.reserve(quads * indices_per_quad);
+  for(unsigned int i = 0; i != quads; ++i) {
+    GLushort const index_offset = cast_if_required<GLushort>(i * 4);
+    quad_indices.emplace_back(index_offset + 0);
+    quad_indices.emplace_back(index_offset + 1);
+    quad_indices.emplace_back(index_offset + 2);
+    #ifdef GUISTORM_AVOIDQUADS
+      quad_indices.emplace_back(index_offset + 0);                              // doing this as indexed triangles instead of deprecated quads costs 50% more index entries
+      quad_indices.emplace_back(index_offset + 2);
+    #endif // GUISTORM_AVOIDQUADS
+    quad_indices.emplace_back(index_offset + 3);
+  }
+  backend &render_backend = *parent_gui.render_backend;
+  render_backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  render_backend.buffer_data(GL_ELEMENT_ARRAY_BUFFER, cast_if_required<GLsizeiptr>(quad_indices.size() * sizeof(GLushort)), &quad_indices[0], GL_STATIC_DRAW);
+  ++parent_gui.stats.buffer_uploads;
+  parent_gui.stats.bytes_uploaded += quad_indices.size() * sizeof(GLushort);
+  ibo_quads = quads;
+}
+
+void batch::set_vertex_pointers(size_t first_vertex) {
+  /// Point the vertex attributes at the stream, starting from the given vertex
+  size_t const offset = first_vertex * sizeof(vertex);
+  backend &render_backend = *parent_gui.render_backend;
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, coords));
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, texcoords));
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour,        4, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, colour) + offsetof(paint, colour));
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour_target, 4, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, colour) + offsetof(paint, colour_target));
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_transition,    4, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, colour) + offsetof(paint, transition));
+  #else
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour,    4, GL_FLOAT, GL_FALSE, sizeof(vertex), offset + offsetof(vertex, colour));
+  #endif // GUISTORM_GPU_TRANSITIONS
+}
+
+void batch::push_rect(coordtype const &corner0, coordtype const &corner1, paint const &colour) {
+  /// Append a solid axis-aligned rectangle
+  push_textured_rect(corner0, corner1, coordtype(1.0f, 1.0f), coordtype(1.0f, 1.0f), colour); // the usual texcoords for untextured geometry
+}
+void batch::push_textured_rect(coordtype const &corner0,
+                               coordtype const &corner1,
+                               coordtype const &texcoord0,
+                               coordtype const &texcoord1,
+                               paint const &colour) {
+  /// Append an axis-aligned rectangle sampling a rectangle of the texture, clipped to the clip rect
+  /// Clipped edges take their texcoords with them, so what's left of a glyph or texture still lines up
+  if(is_clipped_out(corner0, corner1)) {
+    return;
+  }
+  coordtype clipped0(corner0);
+  coordtype clipped1(corner1);
+  coordtype clipped_texcoord0(texcoord0);
+  coordtype clipped_texcoord1(texcoord1);
+  clip_span(clipped0.x, clipped1.x, clipped_texcoord0.x, clipped_texcoord1.x, clip_corner0.x, clip_corner1.x);
+  clip_span(clipped0.y, clipped1.y, clipped_texcoord0.y, clipped_texcoord1.y, clip_corner0.y, clip_corner1.y);
+  if(clipped0.x == clipped1.x || clipped0.y == clipped1.y) {
+    return;                                                                     // only an edge touched the clip rect
+  }
+  push_quad(vertex(coordtype(clipped0.x, clipped0.y), coordtype(clipped_texcoord0.x, clipped_texcoord0.y)),
+            vertex(coordtype(clipped1.x, clipped0.y), coordtype(clipped_texcoord1.x, clipped_texcoord0.y)),
+            vertex(coordtype(clipped1.x, clipped1.y), coordtype(clipped_texcoord1.x, clipped_texcoord1.y)),
+            vertex(coordtype(clipped0.x, clipped1.y), coordtype(clipped_texcoord0.x, clipped_texcoord1.y)),
+            colour);
+}
+
+void batch::push_line(coordtype const &start, coordtype const &end, paint const &colour) {
+  /// Append a line segment, as a quad of the standard line width
+  coordtype const direction(end - start);
+  coordcomponent const length = std::sqrt((direction.x * direction.x) + (direction.y * direction.y));
+  if(length == 0.0f) {
+    return;                                                                     // zero length lines have no direction to draw in
+  }
+  coordtype const normal(coordtype(-direction.y, direction.x) * (line_width * 0.5f / length));
+  if(is_clipped_out(start, end)) {
+    return;
+  }
+  coordtype clipped_start(start);
+  coordtype clipped_end(end);
+  if(std::min(start.x, end.x) < clip_corner0.x || std::min(start.y, end.y) < clip_corner0.y ||
+     std::max(start.x, end.x) > clip_corner1.x || std::max(start.y, end.y) > clip_corner1.y) { // only clip lines that cross the clip rect
+    coordcomponent enter = 0.0f;                                                // how far along the line it enters and leaves the clip rect
+    coordcomponent leave = 1.0f;
+    for(auto const &[along, distance] : {std::make_pair(-direction.x, start.x - clip_corner0.x),
+                                         std::make_pair( direction.x, clip_corner1.x - start.x),
+                                         std::make_pair(-direction.y, start.y - clip_corner0.y),
+                                         std::make_pair( direction.y, clip_corner1.y - start.y)}) {
+      if(along == 0.0f) {
+        continue;                                                               // parallel to this edge, and already known not to be outside it
+      }
+      coordcomponent const crossing = distance / along;
+      if(along < 0.0f) {
+        enter = std::max(enter, crossing);
+      } else {
+        leave = std::min(leave, crossing);
+      }
+    }
+    if(enter >= leave) {
+      return;                                                                   // passes by a corner without entering
+    }
+    clipped_start = start + direction * enter;
+    clipped_end   = start + direction * leave;
+  }
+  push_quad(vertex(clipped_start + normal),                                     // still as wide as ever, so may overhang the clip rect by half the line width
+            vertex(clipped_end   + normal),
+            vertex(clipped_end   - normal),
+            vertex(clipped_start - normal),
+            colour);
+}
+
+void batch::render(GLuint texture) {
+  /// Upload this frame's geometry and draw it all, in a single call unless there are too many quads for 16 bit
+  /// indices or some of them sample a texture of their own
+  /// The gui's shader must already be bound - quads sample the given texture unless they were added with their own
+  unsigned int const quads = get_quad_count();
+  if(quads == 0) {
+    return;                                                                     // nothing to draw
+  }
+  if(__builtin_expect(vbo == 0, 0)) {                                           // if the buffers haven't been generated yet (unlikely)
+    init_buffer();
+  }
+  backend &render_backend = *parent_gui.render_backend;
+  bool const specify_pointers = bind_attributes();
+  if(specify_pointers) {
+    pointers_set = false;
+  }
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(instanced) {
+      upload_instances(specify_pointers);
+    } else {
+      expand_instances();                                                       // no instancing available, so fall back to streaming every vertex
+      for(GLuint const attrib : {parent_gui.attrib_coords_basis, parent_gui.attrib_texcoords_basis}) {
+        render_backend.vertex_attrib4f(attrib, 0.0f, 0.0f, 0.0f, 0.0f);         // each vertex then stands alone at its own coords
+      }
+      upload_vertices(quads);
+    }
+  #else
+    upload_vertices(quads);
+  #endif // GUISTORM_INSTANCED_QUADS
+
+  if(texture_runs.empty()) {
+    draw_quads(0, quads);                                                       // almost always everything samples the same texture
+  } else {
+    for(auto it = texture_runs.begin(); it != texture_runs.end(); ++it) {
+      unsigned int const end_quad = (it + 1 == texture_runs.end()) ? quads : (it + 1)->first_quad;
+      if(end_quad == it->first_quad) {
+        continue;                                                               // the texture changed again before anything was added
+      }
+      render_backend.bind_texture(GL_TEXTURE_2D, it->texture == 0 ? texture : it->texture);
+      render_backend.uniform1f(parent_gui.uniform_texture_colour, it->texture == 0 ? 0.0f : 1.0f);
+      draw_quads(it->first_quad, end_quad - it->first_quad);
+    }
+    render_backend.bind_texture(GL_TEXTURE_2D, texture);                        // leave things as the gui set them up
+    render_backend.uniform1f(parent_gui.uniform_texture_colour, 0.0f);
+  }
+  unbind_attributes();
+  #ifdef GUISTORM_UNBIND
+    render_backend.bind_buffer(GL_ARRAY_BUFFER,         0);
+    render_backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  #endif // GUISTORM_UNBIND
+}
+
+void batch::upload_vertices(unsigned int quads) {
+  /// Stream this frame's vertices to the gpu, and make sure the shared indices cover the biggest draw
+  backend &render_backend = *parent_gui.render_backend;
+  reserve_quad_indices(std::min(quads, max_quads_per_draw));
+  render_backend.bind_buffer(GL_ARRAY_BUFFER,         vbo);
+  render_backend.buffer_data(GL_ARRAY_BUFFER,         cast_if_required<GLsizeiptr>(vertices.size() * sizeof(vertex)), &vertices[0], GL_STREAM_DRAW);
+  render_backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  ++parent_gui.stats.buffer_uploads;
+  parent_gui.stats.bytes_uploaded += vertices.size() * sizeof(vertex);
+}
+
+void batch::point_attributes(unsigned int first_quad) {
+  /// Point the streamed attributes at the given quad, unless they already start there, perhaps since the last frame
+  if(pointers_set && pointers_first_quad == first_quad) {
+    return;
+  }
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(instanced) {
+      set_instance_pointers(first_quad);
+    } else {
+      set_vertex_pointers(first_quad * 4);
+    }
+  #else
+    set_vertex_pointers(first_quad * 4);
+  #endif // GUISTORM_INSTANCED_QUADS
+  pointers_set = true;
+  pointers_first_quad = first_quad;
+}
+
+void batch::draw_quads(unsigned int first_quad, unsigned int quads) {
+  /// Draw a stretch of this frame's uploaded quads, in as many calls as 16 bit indices need
+  backend &render_backend = *parent_gui.render_backend;
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(instanced) {
+      point_attributes(first_quad);
+      #ifdef GUISTORM_AVOIDQUADS
+        render_backend.draw_elements_instanced(GL_TRIANGLES, indices_per_quad, GL_UNSIGNED_SHORT, 0, cast_if_required<GLsizei>(quads));
+      #else
+        render_backend.draw_elements_instanced(GL_QUADS,     indices_per_quad, GL_UNSIGNED_SHORT, 0, cast_if_required<GLsizei>(quads));
+      #endif // GUISTORM_AVOIDQUADS
+      ++parent_gui.stats.draw_calls;
+      return;
+    }
+  #endif // GUISTORM_INSTANCED_QUADS
+  unsigned int const end_quad = first_quad + quads;
+  for(unsigned int draw_first_quad = first_quad; draw_first_quad < end_quad; draw_first_quad += max_quads_per_draw) { // almost always a single pass
+    unsigned int const quads_this_draw = std::min(end_quad - draw_first_quad, max_quads_per_draw);
+    point_attributes(draw_first_quad);                                          // the shared indices count from the first vertex of each draw
+    #ifdef GUISTORM_AVOIDQUADS
+      render_backend.draw_elements(GL_TRIANGLES, cast_if_required<GLsizei>(quads_this_draw * indices_per_quad), GL_UNSIGNED_SHORT, 0);
+    #else
+      render_backend.draw_elements(GL_QUADS,     cast_if_required<GLsizei>(quads_this_draw * indices_per_quad), GL_UNSIGNED_SHORT, 0);
+    #endif // GUISTORM_AVOIDQUADS
+    ++parent_gui.stats.draw_calls;
+  }
+}
+
+bool batch::bind_attributes() {
+  /// Get the vertex attributes ready to draw with, returning whether their pointers need specifying
+  /// With a vertex array object, everything is recorded the first time and only needs binding after that
+  if(vao != 0) {
+    parent_gui.render_backend->bind_vertex_array(vao);
+    if(vao_ready) {
+      return false;
+    }
+    vao_ready = true;
+  }
+  enable_attributes(true);
+  return true;
+}
+void batch::unbind_attributes() {
+  /// Leave the vertex attributes as we found them, for anyone else sharing the context
+  if(vao != 0) {
+    parent_gui.render_backend->bind_vertex_array(0);                            // everything we changed is kept in our own vertex array object
+    return;
+  }
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(instanced) {
+      set_instance_divisors(0);
+    }
+  #endif // GUISTORM_INSTANCED_QUADS
+  enable_attributes(false);
+}
+void batch::enable_attributes(bool enable) {
+  /// Enable or disable every vertex attribute array the shader reads
+  backend &render_backend = *parent_gui.render_backend;
+  auto const set_enabled = [&](GLuint attrib){
+    if(enable) {
+      render_backend.enable_vertex_attrib_array(attrib);
+    } else {
+      render_backend.disable_vertex_attrib_array(attrib);
+    }
+  };
+  set_enabled(parent_gui.attrib_coords);
+  set_enabled(parent_gui.attrib_texcoords);
+  set_enabled(parent_gui.attrib_colour);
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    set_enabled(parent_gui.attrib_colour_target);
+    set_enabled(parent_gui.attrib_transition);
+  #endif // GUISTORM_GPU_TRANSITIONS
+  #ifdef GUISTORM_INSTANCED_QUADS
+    if(instanced) {
+      set_enabled(parent_gui.attrib_corner);
+      set_enabled(parent_gui.attrib_coords_basis);
+      set_enabled(parent_gui.attrib_texcoords_basis);
+    }
+  #endif // GUISTORM_INSTANCED_QUADS
+}
+
+#ifdef GUISTORM_INSTANCED_QUADS
+void batch::expand_instances() {
+  /// Convert this frame's instances into plain vertices, for backends without instancing
+  vertices.clear();
+  vertices.reserve(instances.size() * 4);
+  for(auto const &this_instance : instances) {
+    vertex const v0(this_instance.coords,
+                    this_instance.texcoords,
+                    this_instance.colour);
+    vertex const v1(this_instance.coords    + this_instance.coords_u,
+                    this_instance.texcoords + this_instance.texcoords_u,
+                    this_instance.colour);
+    vertex const v2(this_instance.coords    + this_instance.coords_u    + this_instance.coords_v,
+                    this_instance.texcoords + this_instance.texcoords_u + this_instance.texcoords_v,
+                    this_instance.colour);
+    vertex const v3(this_instance.coords    + this_instance.coords_v,
+                    this_instance.texcoords + this_instance.texcoords_v,
+                    this_instance.colour);
+    append_quad(v0, v1, v2, v3);
+  }
+}
+
+void batch::upload_instances(bool specify_pointers) {
+  /// Stream this frame's instances to the gpu, setting up the unit square they're all drawn from if need be
+  backend &render_backend = *parent_gui.render_backend;
+  if(specify_pointers) {
+    render_backend.bind_buffer(GL_ARRAY_BUFFER, quad_vbo);
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_corner, 2, GL_FLOAT, GL_FALSE, sizeof(coordtype), 0);
+    set_instance_divisors(1);                                                   // advance once per quad rather than per corner
+  }
+  render_backend.bind_buffer(GL_ARRAY_BUFFER,         vbo);
+  render_backend.buffer_data(GL_ARRAY_BUFFER,         cast_if_required<GLsizeiptr>(instances.size() * sizeof(instance)), &instances[0], GL_STREAM_DRAW);
+  render_backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  ++parent_gui.stats.buffer_uploads;
+  parent_gui.stats.bytes_uploaded += instances.size() * sizeof(instance);
+}
+
+void batch::set_instance_pointers(size_t first_instance) {
+  /// Point the per-instance attributes at the stream, starting from the given instance
+  size_t const offset = first_instance * sizeof(instance);
+  backend &render_backend = *parent_gui.render_backend;
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_coords,          2, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, coords));
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_coords_basis,    4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, coords_u)); // coords_u and coords_v together
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_texcoords,       2, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, texcoords));
+  render_backend.vertex_attrib_pointer(parent_gui.attrib_texcoords_basis, 4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, texcoords_u)); // texcoords_u and texcoords_v together
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour,        4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, colour) + offsetof(paint, colour));
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour_target, 4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, colour) + offsetof(paint, colour_target));
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_transition,    4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, colour) + offsetof(paint, transition));
+  #else
+    render_backend.vertex_attrib_pointer(parent_gui.attrib_colour,        4, GL_FLOAT, GL_FALSE, sizeof(instance), offset + offsetof(instance, colour));
+  #endif // GUISTORM_GPU_TRANSITIONS
+}
+
+void batch::set_instance_divisors(GLuint divisor) {
+  /// Set the divisor of every attribute read per instance
+  backend &render_backend = *parent_gui.render_backend;
+  render_backend.vertex_attrib_divisor(parent_gui.attrib_coords,          divisor);
+  render_backend.vertex_attrib_divisor(parent_gui.attrib_coords_basis,    divisor);
+  render_backend.vertex_attrib_divisor(parent_gui.attrib_texcoords,       divisor);
+  render_backend.vertex_attrib_divisor(parent_gui.attrib_texcoords_basis, divisor);
+  render_backend.vertex_attrib_divisor(parent_gui.attrib_colour,          divisor);
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    render_backend.vertex_attrib_divisor(parent_gui.attrib_colour_target, divisor);
+    render_backend.vertex_attrib_divisor(parent_gui.attrib_transition,    divisor);
+  #endif // GUISTORM_GPU_TRANSITIONS
+}
+#endif // GUISTORM_INSTANCED_QUADS
+
+}
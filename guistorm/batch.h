@@ -0,0 +1,170 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include "types.h"
+
+namespace guistorm {
+
+class gui;                                                                      // forward declarations
+
+class batch {
+  /// Streaming renderer that collects the geometry of every visible element
+  /// in painter's order each frame, and draws it with as few calls as possible.
+  /// All geometry is decomposed into quads, so backgrounds, outlines, lines and
+  /// glyphs can all share the same draw calls.  Colour is carried per vertex,
+  /// so elements in different states don't need to break the batch; only quads
+  /// sampling a texture of their own, such as a cached window, break it.
+  /// Everything added is clipped to the clip rect on the way in, so clipping
+  /// windows' contents doesn't break it either.
+public:
+  struct vertex {
+    coordtype coords;
+    coordtype texcoords;
+    paint colour;                                                               // a plain colour, or a colour transition with GUISTORM_GPU_TRANSITIONS
+    vertex(coordtype const &new_coords,
+           coordtype const &new_texcoords = coordtype(1.0, 1.0),
+           paint const &new_colour        = paint(colourtype(1.0, 1.0, 1.0, 1.0)))
+    : coords(new_coords),
+      texcoords(new_texcoords),
+      colour(new_colour) {
+      /// Specific constructor
+    }
+  };
+
+  struct glyph_quad {
+    /// One glyph of a label, as an axis-aligned rect and the rect it samples from the font atlas
+    coordtype corner0;                                                          // lower left corner, relative to the element
+    coordtype corner1;                                                          // upper right corner, relative to the element
+    coordtype texcoord0;                                                        // atlas texcoords of the lower left corner
+    coordtype texcoord1;                                                        // atlas texcoords of the upper right corner
+    glyph_quad(coordtype const &new_corner0,
+               coordtype const &new_corner1,
+               coordtype const &new_texcoord0,
+               coordtype const &new_texcoord1)
+    : corner0(new_corner0),
+      corner1(new_corner1),
+      texcoord0(new_texcoord0),
+      texcoord1(new_texcoord1) {
+      /// Specific constructor
+    }
+  };
+
+  struct texture_run {
+    /// Where the quads switch to sampling a different texture, such as a cached window
+    GLuint texture;                                                             // the texture sampled from here on, or 0 for the one the batch is rendered with
+    unsigned int first_quad;
+    texture_run(GLuint new_texture, unsigned int new_first_quad)
+    : texture(new_texture),
+      first_quad(new_first_quad) {
+      /// Specific constructor
+    }
+  };
+
+  #ifdef GUISTORM_INSTANCED_QUADS
+    struct instance {
+      /// One quad, drawn as the unit square mapped onto the screen and the texture
+      /// Every quad we draw is a parallelogram, so three corners are enough to place it
+      coordtype coords;                                                         // screen position of the first corner
+      coordtype coords_u;                                                       // screen edge from the first corner to the second
+      coordtype coords_v;                                                       // screen edge from the first corner to the fourth
+      coordtype texcoords;                                                      // texture position of the first corner
+      coordtype texcoords_u;                                                    // texture edge from the first corner to the second
+      coordtype texcoords_v;                                                    // texture edge from the first corner to the fourth
+      paint colour;
+      instance(vertex const &v0, vertex const &v1, vertex const &v3, paint const &new_colour)
+      : coords(     v0.coords),
+        coords_u(   v1.coords    - v0.coords),
+        coords_v(   v3.coords    - v0.coords),
+        texcoords(  v0.texcoords),
+        texcoords_u(v1.texcoords - v0.texcoords),
+        texcoords_v(v3.texcoords - v0.texcoords),
+        colour(new_colour) {
+        /// Specific constructor
+      }
+    };
+  #endif // GUISTORM_INSTANCED_QUADS
+
+  static coordcomponent constexpr line_width = 1.0f;                            // thickness of outlines and lines, in screen pixels
+  static unsigned int constexpr max_quads_per_draw = 16384;                     // the most quads 16 bit indices can address - bigger frames are split into several draws
+  #ifdef GUISTORM_AVOIDQUADS
+    static unsigned int constexpr indices_per_quad = 6;                         // two triangles
+  #else
+    static unsigned int constexpr indices_per_quad = 4;
+  #endif // GUISTORM_AVOIDQUADS
+
+private:
+  gui &parent_gui;                                                              // the gui whose shader we render with
+
+  GLuint vbo = 0;                                                               // stream vertex buffer, refilled every frame
+  GLuint ibo = 0;                                                               // shared quad index buffer - every quad uses the same pattern, so this is only uploaded when it needs to grow
+  unsigned int ibo_quads = 0;                                                   // how many quads the index buffer covers so far
+  GLuint vao = 0;                                                               // vertex array object recording our attribute setup between frames, if the context has them
+  bool vao_ready = false;                                                       // whether the attribute setup has been recorded in the vao yet
+  bool pointers_set = false;                                                    // whether the attribute pointers have been set, and still hold in the vao if we have one
+  unsigned int pointers_first_quad = 0;                                         // which quad the attribute pointers currently start from
+
+  std::vector<vertex> vertices;                                                 // this frame's vertex stream in painter's order, four per quad, in window pixels - kept between frames to reuse allocations
+  std::vector<texture_run> texture_runs;                                        // this frame's changes of texture in painter's order - empty while every quad samples the same one
+  coordtype clip_corner0{std::numeric_limits<coordcomponent>::lowest(), std::numeric_limits<coordcomponent>::lowest()}; // everything added is clipped to this rect, in window pixels - lower left
+  coordtype clip_corner1{std::numeric_limits<coordcomponent>::max(),    std::numeric_limits<coordcomponent>::max()}; // upper right
+
+  #ifdef GUISTORM_INSTANCED_QUADS
+    GLuint quad_vbo = 0;                                                        // corners of the unit square, shared by every instance, indexed by the first quad of ibo
+    bool instanced = false;                                                     // whether the backend can draw instances - if not, they're expanded into the vertex stream
+    std::vector<instance> instances;                                            // this frame's quads, in painter's order - streamed through vbo when instanced
+  #endif // GUISTORM_INSTANCED_QUADS
+
+public:
+  batch(gui &parent_gui);
+  ~batch();
+
+  void init_buffer();
+  void destroy_buffer();
+
+  void clear();
+
+  void add_rect(      coordtype const &corner0, coordtype const &corner1, paint const &colour);
+  void add_outline(   coordtype const &corner0, coordtype const &corner1, paint const &colour);
+  void add_line(      coordtype const &start,   coordtype const &end,     paint const &colour);
+  void add_line_strip(std::vector<coordtype> const &points, coordtype const &offset, paint const &colour);
+  void add_lines(     std::vector<vertex> const &points, std::vector<GLuint> const &pairs, coordtype const &offset, paint const &colour);
+  void add_glyphs(    std::vector<glyph_quad> const &glyphs, coordtype const &offset, paint const &colour);
+  void add_texture(   coordtype const &corner0, coordtype const &corner1, GLuint texture, paint const &colour);
+
+  void set_clip(      coordtype const &corner0, coordtype const &corner1);
+  void intersect_clip(coordtype const &corner0, coordtype const &corner1);
+  coordtype const &get_clip_corner0() const __attribute__((__const__));
+  coordtype const &get_clip_corner1() const __attribute__((__const__));
+  bool is_clipped_out(coordtype const &corner0, coordtype const &corner1) const __attribute__((__pure__));
+
+private:
+  static bool is_transparent(paint const &colour) __attribute__((__pure__));
+  static void clip_span(coordcomponent &corner0, coordcomponent &corner1, coordcomponent &texcoord0, coordcomponent &texcoord1, coordcomponent lower, coordcomponent upper);
+  void push_quad(vertex const &v0, vertex const &v1, vertex const &v2, vertex const &v3, paint const &colour);
+  void push_rect(coordtype const &corner0, coordtype const &corner1, paint const &colour);
+  void push_textured_rect(coordtype const &corner0, coordtype const &corner1, coordtype const &texcoord0, coordtype const &texcoord1, paint const &colour);
+  void push_line(coordtype const &start, coordtype const &end, paint const &colour);
+  void append_quad(vertex const &v0, vertex const &v1, vertex const &v2, vertex const &v3);
+  void set_texture(GLuint texture);
+  unsigned int get_quad_count() const __attribute__((__pure__));
+  void reserve_quad_indices(unsigned int quads);
+  void upload_vertices(unsigned int quads);
+  void set_vertex_pointers(size_t first_vertex);
+  void point_attributes(unsigned int first_quad);
+  void draw_quads(unsigned int first_quad, unsigned int quads);
+  bool bind_attributes();
+  void unbind_attributes();
+  void enable_attributes(bool enable);
+  #ifdef GUISTORM_INSTANCED_QUADS
+    void expand_instances();
+    void upload_instances(bool specify_pointers);
+    void set_instance_pointers(size_t first_instance);
+    void set_instance_divisors(GLuint divisor);
+  #endif // GUISTORM_INSTANCED_QUADS
+
+public:
+  void render(GLuint texture);
+};
+
+}
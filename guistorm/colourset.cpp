@@ -1,8 +1,10 @@
 #include "colourset.h"
+#include <algorithm>
 
 namespace guistorm {
 
-colourset::colourset() {
+colourset::colourset()
+  : colour_palette(palette::intern(palette())) {
   /// Default constructor
 }
 
@@ -12,13 +14,16 @@ colourset::colourset(colourgroup const &colour_current,
                      colourgroup const &colour_focus,
                      colourgroup const &colour_active)
   : current(colour_current),
-    idle(colour_idle),
-    hover(colour_hover),
-    focus(colour_focus),
-    active(colour_active) {
+    colour_palette(palette::intern(palette(colour_idle, colour_hover, colour_focus, colour_active))) {
   /// Specific constructor
 }
 
+colourset::colourset(std::shared_ptr<palette const> const &shared_palette)
+  : current(shared_palette->idle),
+    colour_palette(shared_palette) {
+  /// Construct from an existing palette, such as a theme shared with other elements
+}
+
 colourset::~colourset() {
   /// Default destructor
 }
@@ -28,12 +33,148 @@ void colourset::assign(colourgroup const &new_current,
                        colourgroup const &new_hover,
                        colourgroup const &new_focus,
                        colourgroup const &new_active) {
-  /// Assign a new set of colourgroups to this set
+  /// Assign a new set of colourgroups to this set, keeping the existing timings
+  palette new_palette(*colour_palette);
+  new_palette.assign(new_idle, new_hover, new_focus, new_active);
+  colour_palette = palette::intern(new_palette);
   current = new_current;
-  idle    = new_idle;
-  hover   = new_hover;
-  focus   = new_focus;
-  active  = new_active;
+}
+
+palette const &colourset::get_palette() const {
+  /// Return the palette we're drawn with
+  return *colour_palette;
+}
+void colourset::set_palette(std::shared_ptr<palette const> const &new_palette, float time) {
+  /// Switch to a different palette, fading to its colours from wherever we are now
+  current = get_colours_at(time);
+  colour_palette = new_palette;
+  restart_transition(time);
+}
+
+colourgroup const &colourset::get(statetype state) const {
+  /// Return the colourgroup for a given state
+  return colour_palette->get(state);
+}
+float colourset::get_duration(statetype state) const {
+  /// Return how long a transition to a given state takes, in seconds
+  return colour_palette->get_duration(state);
+}
+colourset::statetype colourset::get_state() const {
+  /// Return the state we're in or transitioning towards
+  return transition_state;
+}
+bool colourset::is_transitioning() const {
+  /// Return whether the current colours are still on their way to the target
+  return transitioning;
+}
+
+float colourset::get_progress(float time) const {
+  /// Return how far along the transition we are at a given gui time, from 0 to 1 after easing
+  /// The shader evaluates exactly the same curve when GUISTORM_GPU_TRANSITIONS is in use
+  float const duration = get_duration(transition_state);
+  if(duration <= 0.0f) {
+    return 1.0f;
+  }
+  float const t = std::clamp((time - transition_start_time) / duration, 0.0f, 1.0f);
+  switch(colour_palette->easing) {
+  case easetype::LINEAR:
+    return t;
+  case easetype::EASE_IN:
+    return t * t;
+  case easetype::EASE_IN_OUT:
+    return t * t * (3.0f - (2.0f * t));                                         // smoothstep
+  case easetype::EASE_OUT:
+  default:
+    return t * (2.0f - t);
+  }
+}
+colourgroup colourset::get_colours_at(float time) const {
+  /// Return what the colours are at a given gui time
+  if(!transitioning) {
+    return get(transition_state);
+  }
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    colourgroup result(current);
+  #else
+    colourgroup result(transition_start);
+  #endif // GUISTORM_GPU_TRANSITIONS
+  result.blend_to(get(transition_state), get_progress(time));
+  return result;
+}
+
+#ifdef GUISTORM_GPU_TRANSITIONS
+  paint colourset::get_paint_background() const {
+    /// Return the background colour transition, for the shader to evaluate
+    if(!transitioning) {
+      return paint(get(transition_state).background);
+    }
+    float const duration = get_duration(transition_state);
+    return paint(current.background, get(transition_state).background, transition_start_time, duration, colour_palette->easing);
+  }
+  paint colourset::get_paint_outline() const {
+    /// Return the outline colour transition, for the shader to evaluate
+    if(!transitioning) {
+      return paint(get(transition_state).outline);
+    }
+    float const duration = get_duration(transition_state);
+    return paint(current.outline, get(transition_state).outline, transition_start_time, duration, colour_palette->easing);
+  }
+  paint colourset::get_paint_content() const {
+    /// Return the content colour transition, for the shader to evaluate
+    if(!transitioning) {
+      return paint(get(transition_state).content);
+    }
+    float const duration = get_duration(transition_state);
+    return paint(current.content, get(transition_state).content, transition_start_time, duration, colour_palette->easing);
+  }
+#else
+  paint const &colourset::get_paint_background() const {
+    /// Return the background colour to draw with
+    return transitioning ? current.background : get(transition_state).background;
+  }
+  paint const &colourset::get_paint_outline() const {
+    /// Return the outline colour to draw with
+    return transitioning ? current.outline : get(transition_state).outline;
+  }
+  paint const &colourset::get_paint_content() const {
+    /// Return the content colour to draw with
+    return transitioning ? current.content : get(transition_state).content;
+  }
+#endif // GUISTORM_GPU_TRANSITIONS
+
+bool colourset::transition_to(statetype new_state, float time) {
+  /// Begin transitioning towards a new state from wherever we are now, if we aren't already heading there
+  /// Returns true if a new transition was started
+  if(new_state == transition_state) {
+    return false;
+  }
+  current = get_colours_at(time);                                               // pick up from mid-transition if need be
+  transition_state = new_state;
+  restart_transition(time);
+  return true;
+}
+void colourset::restart_transition(float time) {
+  /// Begin a fresh transition from the current colours to the current state, for instance after any colours have changed
+  #ifndef GUISTORM_GPU_TRANSITIONS
+    transition_start = current;
+  #endif // GUISTORM_GPU_TRANSITIONS
+  transition_start_time = time;
+  transitioning = true;
+}
+bool colourset::advance(float time) {
+  /// Move the current colours along the transition to the given gui time
+  /// Returns true if the transition has further to go, false once it's complete
+  if(!transitioning) {
+    return false;
+  }
+  if(get_progress(time) >= 1.0f) {
+    transitioning = false;                                                      // from now on we draw straight from the palette
+    return false;
+  }
+  #ifndef GUISTORM_GPU_TRANSITIONS
+    current = get_colours_at(time);
+  #endif // GUISTORM_GPU_TRANSITIONS
+  return true;
 }
 
 void colourset::blend_to(colourgroup const &target, float factor) {
@@ -43,16 +184,16 @@ void colourset::blend_to(colourgroup const &target, float factor) {
 
 void colourset::blend_to_idle(float factor) {
   /// Shortcuts to blend towards existing colours
-  blend_to(idle, factor);
+  blend_to(colour_palette->idle, factor);
 }
 void colourset::blend_to_hover(float factor) {
-  blend_to(hover, factor);
+  blend_to(colour_palette->hover, factor);
 }
 void colourset::blend_to_focus(float factor) {
-  blend_to(focus, factor);
+  blend_to(colour_palette->focus, factor);
 }
 void colourset::blend_to_active(float factor) {
-  blend_to(active, factor);
+  blend_to(colour_palette->active, factor);
 }
 
 }
@@ -1,18 +1,31 @@
 #pragma once
 
-#include "colourgroup.h"
+#include <memory>
+#include "palette.h"
 
 namespace guistorm {
 
 class colourset {
+  /// An element's colours: the palette it's drawn with, shared with other
+  /// elements, and its own progress transitioning between the palette's states.
+  /// Outside of a transition the palette's colours are drawn directly, so
+  /// changing a shared palette restyles every element using it once
+  /// gui::restyle() has cleared any cached copies of them.
 public:
-  // a complete set of colours for this widget
-  colourgroup current;                                                          // current colour of this element
+  using statetype = palette::statetype;
 
-  colourgroup idle;                                                             // default colours at idle
-  colourgroup hover;                                                            // mouseover colours
-  colourgroup focus;                                                            // focus colours (when an element is currently selected for input)
-  colourgroup active;                                                           // active colours (while mouse_pressed / when text is being entered)
+  colourgroup current;                                                          // colours mid-transition - with GUISTORM_GPU_TRANSITIONS, the colours the transition started from
+
+private:
+  std::shared_ptr<palette const> colour_palette;                                // the colours for each state, shared
+  #ifndef GUISTORM_GPU_TRANSITIONS
+    colourgroup transition_start;                                               // the current colours when the transition began
+  #endif // GUISTORM_GPU_TRANSITIONS
+  statetype transition_state = statetype::IDLE;                                 // the colourgroup we're transitioning towards
+  float transition_start_time = 0.0f;                                           // gui time when the transition began, in seconds
+  bool transitioning = false;                                                   // whether current may still differ from the target
+
+public:
 
   colourset();
   colourset(colourgroup const &current,
@@ -20,6 +33,7 @@ public:
             colourgroup const &hover,
             colourgroup const &focus,
             colourgroup const &active);
+  colourset(std::shared_ptr<palette const> const &shared_palette);
   ~colourset();
 
   void assign(colourgroup const &new_current,
@@ -28,6 +42,30 @@ public:
               colourgroup const &new_focus,
               colourgroup const &new_active);
 
+  palette const &get_palette() const __attribute__((__pure__));
+  void set_palette(std::shared_ptr<palette const> const &new_palette, float time);
+
+  colourgroup const &get(statetype state) const __attribute__((__pure__));
+  float get_duration(statetype state) const __attribute__((__pure__));
+  statetype get_state() const __attribute__((__pure__));
+  bool is_transitioning() const __attribute__((__pure__));
+
+  float get_progress(float time) const __attribute__((__pure__));
+  colourgroup get_colours_at(float time) const __attribute__((__pure__));
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    paint get_paint_background() const __attribute__((__pure__));
+    paint get_paint_outline()    const __attribute__((__pure__));
+    paint get_paint_content()    const __attribute__((__pure__));
+  #else
+    paint const &get_paint_background() const __attribute__((__pure__));
+    paint const &get_paint_outline()    const __attribute__((__pure__));
+    paint const &get_paint_content()    const __attribute__((__pure__));
+  #endif // GUISTORM_GPU_TRANSITIONS
+
+  bool transition_to(statetype new_state, float time);
+  void restart_transition(float time);
+  bool advance(float time);
+
   void blend_to(colourgroup const &target, float factor);
   void blend_to_idle(  float factor);
   void blend_to_hover( float factor);
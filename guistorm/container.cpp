@@ -2,6 +2,7 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include "cast_if_required.h"
 #include "base.h"
+#include "gui.h"
 #ifndef NDEBUG
   #include <iostream>
 #endif
@@ -30,8 +31,11 @@ unsigned int container::add(base *element) {
     }
   #endif
   elements.emplace_back(element);
-  elements.back()->parent = this;
+  elements.back()->parent      = this;
+  elements.back()->parent_base = as_base();
+  elements.back()->invalidate_absolute_position();                              // in case it's been moved here from another container
   add_to_gui(element);
+  element->invalidate_render_cache();
   return cast_if_required<unsigned int>(elements.size()) - 1;
 }
 
@@ -47,7 +51,16 @@ void container::remove(unsigned int index) {
       abort();
     }
   #endif
+  #ifdef GUISTORM_PICK_GRID
+    if(elements[index]->parent_gui) {
+      elements[index]->parent_gui->pick_index.invalidate_all();                 // ranks have changed
+    }
+  #endif // GUISTORM_PICK_GRID
+  elements[index]->damage_drawn();
   elements.erase(elements.begin() + index);
+  if(base *const this_base = as_base()) {
+    this_base->invalidate_render_cache();
+  }
 }
 void container::remove(base const *const thiselement) {
   /// Remove an element from this gui by its address
@@ -59,7 +72,17 @@ void container::remove(base const *const thiselement) {
   #endif
   //elements.erase(elements.begin() + index);
   //elements.erase(std::remove_if(elements.begin(), elements.end(), is_purchased_plot), elements.end());
-  elements.erase(std::find(elements.begin(), elements.end(), thiselement));
+  #ifdef GUISTORM_PICK_GRID
+    if(thiselement->parent_gui) {
+      thiselement->parent_gui->pick_index.invalidate_all();                     // ranks have changed
+    }
+  #endif // GUISTORM_PICK_GRID
+  auto const it = std::find(elements.begin(), elements.end(), thiselement);
+  (*it)->damage_drawn();
+  elements.erase(it);
+  if(base *const this_base = as_base()) {
+    this_base->invalidate_render_cache();
+  }
 }
 
 base *container::get(unsigned int index) const {
@@ -85,6 +108,9 @@ void container::clear() {
     delete element;
   }
   elements.clear();
+  if(base *const this_base = as_base()) {
+    this_base->invalidate_render_cache();
+  }
 }
 
 base *container::get_picked(coordtype const &cursor_position) {
@@ -93,6 +119,7 @@ base *container::get_picked(coordtype const &cursor_position) {
     lock_iterating = true;
   #endif
   for(auto &element : elements | boost::adaptors::reversed) {                   // we iterate in reverse so most on-top object from equal tiers appears first
+    ++element->parent_gui->stats.pick_nodes_visited;
     base *picked_element(element->get_picked(cursor_position));
     if(picked_element) {
       #ifndef NDEBUG
@@ -107,6 +134,11 @@ base *container::get_picked(coordtype const &cursor_position) {
   return nullptr;
 }
 
+base *container::as_base() {
+  /// Return this container as an element, if it is one - only the top level gui isn't
+  return nullptr;
+}
+
 coordtype const container::get_absolute_position() const {
   /// Return the absolute screen coords of the origin of this element
   /// This function is only called on a container that is not also an element, so it is always going to be top level
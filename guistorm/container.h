@@ -35,6 +35,7 @@ public:
   virtual void add_to_gui(base *element) = 0;
 
   virtual base *get_picked(coordtype const &cursor_position);
+  virtual base *as_base() __attribute__((__const__));
   virtual coordtype const get_absolute_position() const;
 
   virtual void destroy_buffer();
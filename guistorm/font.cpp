@@ -1,7 +1,13 @@
 #ifndef GUISTORM_NO_TEXT
 
 //#include "font.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#ifndef GUISTORM_NO_FREETYPE
+  #include <iomanip>
+  #include <freetype-gl/texture-atlas.h>
+#endif // GUISTORM_NO_FREETYPE
 #include "gui.h"
 
 namespace guistorm {
@@ -19,16 +25,14 @@ namespace guistorm {
   #endif // GUISTORM_NO_UTF
     return 0.0f;
   }
-  GLfloat result = 0.0f;
-  try {
-    #ifdef DEBUG_GUISTORM
-      //std::cout << "GUIStorm: DEBUG: kerning from \"" << charcode_last << "\" (ascii " << static_cast<int>(charcode_last) << ")" << " to \"" << charcode << "\" (ascii " << static_cast<int>(charcode) << ")" << std::endl;
-    #endif
-    result = kerning.at(charcode_last);
-  } catch(std::out_of_range const &e) {
-    result = 0.0f;
+  #ifdef DEBUG_GUISTORM
+    //std::cout << "GUIStorm: DEBUG: kerning from \"" << charcode_last << "\" (ascii " << static_cast<int>(charcode_last) << ")" << " to \"" << charcode << "\" (ascii " << static_cast<int>(charcode) << ")" << std::endl;
+  #endif
+  auto const it = kerning.find(charcode_last);
+  if(it == kerning.end()) {
+    return 0.0f;                                                                // only non-zero kerning pairs are stored
   }
-  return result;
+  return it->second;
 }
 
 GLfloat font::word::length() const {
@@ -89,9 +93,29 @@ font::font(gui *new_parent_gui,
   }
 }
 
+font::font(gui *new_parent_gui,
+           baked_font const &new_baked)
+  : parent_gui(new_parent_gui),
+    name(new_baked.name),
+    baked(&new_baked),
+    font_size(new_baked.font_size) {
+  /// Specific constructor for a font baked ahead of time with the bake_font tool
+  #ifndef NDEBUG
+    if(!parent_gui) {
+      std::cout << "GUIStorm: Font: ERROR: attempting to create a font with no valid parent!" << std::endl;
+    }
+  #endif
+  for(unsigned int i = 0; i != baked->glyph_count; ++i) {
+    charcodes += static_cast<decltype(charcodes)::value_type>(baked->glyphs[i].charcode); // whatever was baked is all there is
+  }
+}
+
 font::~font() {
   /// Default destructor
   unload();
+  #if defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_FREETYPE)
+    close_live_face();
+  #endif // defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_FREETYPE)
 }
 
 bool font::load_if_needed(freetypeglxx::TextureAtlas *font_atlas) {
@@ -106,8 +130,9 @@ bool font::load_if_needed(freetypeglxx::TextureAtlas *font_atlas) {
 bool font::load(freetypeglxx::TextureAtlas *font_atlas) {
   /// Attempt to load this font into the specified font atlas
   /// Reimplemented form of TextureFont::LoadGlyphs which is a wrapper for texture_font_load_glyphs
+  /// This rasterises and packs in one go on this thread; the gui spreads rasterising many fonts over all cores instead
   #ifndef NDEBUG
-    if(glfwGetCurrentContext() == NULL) {                                       // make sure we're in a valid opengl context before we try to refresh
+    if(parent_gui && !parent_gui->get_backend().has_context()) {                // make sure we're in a valid opengl context before we try to refresh
       std::cout << "GUIStorm: WARNING: Attempting to load fonts with no current GL context, ignoring." << std::endl;
       return false;
     }
@@ -116,11 +141,121 @@ bool font::load(freetypeglxx::TextureAtlas *font_atlas) {
       return false;
     }
   #endif
+  #ifndef GUISTORM_NO_FREETYPE
+    if(!baked) {
+      rasterise_begin();
+      rasterise(0, charcodes.size());
+    }
+  #endif // GUISTORM_NO_FREETYPE
   unload();
-  FT_Library library;
-  FT_Init_FreeType(&library);                                                   // initialise library
-  FT_Face face;
-  FT_New_Memory_Face(library, reinterpret_cast<unsigned char const *>(buffer.data()), buffer.size(), 0, &face); // load face
+  bool const result = pack(font_atlas);
+  #ifndef GUISTORM_NO_FREETYPE
+    rasterise_end();
+  #endif // GUISTORM_NO_FREETYPE
+  return result;
+}
+
+bool font::pack(freetypeglxx::TextureAtlas *font_atlas, bool warn_full) {
+  /// Pack this font's glyphs into the specified font atlas, once they've been rasterised or if it's baked
+  /// Returns false if the atlas is full; once it's grown, packing again carries on from the first glyph missing
+  /// Running out of room is only reported if warn_full is set, for callers that aren't just trying sizes out
+  if(baked) {
+    return load_baked(font_atlas);                                              // nothing to rasterise
+  }
+  #ifdef GUISTORM_NO_FREETYPE
+    std::cout << "GUIStorm: ERROR: cannot load font " << name << " without freetype, only baked fonts can be used with GUISTORM_NO_FREETYPE" << std::endl;
+    return false;
+  #else
+    for(auto const &thisglyph : rasterised) {
+      {
+        std::lock_guard lock(glyph_map_mutex);
+        if(glyphs.find(thisglyph.charcode) != glyphs.end()) {
+          continue;                                                             // already packed before the atlas filled up
+        }
+      }
+      if(pack_glyph(font_atlas, thisglyph, warn_full).x < 0) {
+        if(warn_full) {
+          std::cout << "GUIStorm: WARNING: Failed to load all glyphs." << std::endl;
+        }
+        return false;
+      }
+    }
+    return true;
+  #endif // GUISTORM_NO_FREETYPE
+}
+
+bool font::load_baked(freetypeglxx::TextureAtlas *font_atlas) {
+  /// Copy this font's baked glyphs into the specified font atlas, without rasterising anything
+  /// The baked bitmap goes in as a single region, separated from other glyphs by a blank pixel as usual
+  #ifndef NDEBUG
+    if(parent_gui && parent_gui->get_dpi() != baked->dpi) {
+      std::cout << "GUIStorm: WARNING: font " << name << " was baked at " << baked->dpi << "dpi but the gui is at " << parent_gui->get_dpi() << "dpi, so won't be scaled to match" << std::endl;
+    }
+  #endif
+  unload();
+  freetypeglxx::ivec4 const region = font_atlas->GetRegion(baked->atlas_width + 1, baked->atlas_height + 1);
+  if(region.x < 0) {
+    std::cout << "GUIStorm: WARNING: font load: no room in atlas for baked font " << name << " at size " << font_size << std::endl;
+    return false;                                                               // the gui grows the atlas and tries again
+  }
+  if(baked->atlas_width != 0 && baked->atlas_height != 0) {
+    font_atlas->SetRegion(region.x, region.y, baked->atlas_width, baked->atlas_height, baked->atlas, baked->atlas_width);
+  }
+  metrics_ascender  = baked->metrics_ascender;
+  metrics_descender = baked->metrics_descender;
+  metrics_height    = baked->metrics_height;
+  metrics_linegap   = baked->metrics_linegap;
+
+  GLfloat const atlas_width  = static_cast<GLfloat>(font_atlas->width());
+  GLfloat const atlas_height = static_cast<GLfloat>(font_atlas->height());
+  std::lock_guard lock(glyph_map_mutex);
+  for(unsigned int i = 0; i != baked->glyph_count; ++i) {
+    baked_font::glyph const &source = baked->glyphs[i];
+    std::shared_ptr<font::glyph> tempglyph(new glyph);
+    tempglyph->charcode    = static_cast<decltype(tempglyph->charcode)>(source.charcode);
+    tempglyph->is_blank    = source.is_blank;
+    tempglyph->linebreak   = source.linebreak;
+    tempglyph->offset      = coordtype(source.offset[0],  source.offset[1]);
+    tempglyph->size        = coordtype(source.size[0],    source.size[1]);
+    tempglyph->advance     = coordtype(source.advance[0], source.advance[1]);
+    GLfloat const x = static_cast<GLfloat>(region.x + source.atlas_x);
+    GLfloat const y = static_cast<GLfloat>(region.y + source.atlas_y);
+    tempglyph->texcoord0.x =  x                   / atlas_width;
+    tempglyph->texcoord0.y = (y + source.size[1]) / atlas_height;               // y is flipped for texture coords
+    tempglyph->texcoord1.x = (x + source.size[0]) / atlas_width;
+    tempglyph->texcoord1.y =  y                   / atlas_height;               // y is flipped for texture coords
+    for(unsigned int k = source.kerning_first; k != source.kerning_first + source.kerning_count; ++k) {
+      tempglyph->kerning.emplace(static_cast<decltype(tempglyph->charcode)>(baked->kerning[k].charcode_last), baked->kerning[k].kerning);
+    }
+    glyphs.emplace(tempglyph->charcode, tempglyph);
+  }
+  return true;
+}
+
+#ifndef GUISTORM_NO_FREETYPE
+void font::rasterise_begin() {
+  /// Get ready to rasterise this font's glyphs, which may then be done in ranges on any number of threads
+  #ifdef GUISTORM_LOAD_MISSING_GLYPHS
+    close_live_face();                                                          // the font's being rebuilt, maybe at a new dpi
+  #endif // GUISTORM_LOAD_MISSING_GLYPHS
+  rasterised.clear();
+  rasterised.resize(charcodes.size());
+  for(size_t i = 0; i != charcodes.size(); ++i) {
+    rasterised[i].charcode = charcodes[i];                                      // so even a glyph that fails to rasterise packs as a blank
+  }
+}
+bool font::open_face(FT_Library &library, FT_Face &face) const {
+  /// Open freetype and this font's face at the size and hinting we rasterise at
+  /// Each thread rasterising needs its own, as freetype libraries and faces can't be shared between threads
+  if(FT_Init_FreeType(&library) != 0) {                                         // initialise library
+    std::cout << "GUIStorm: ERROR: cannot initialise freetype to load font " << name << std::endl;
+    return false;
+  }
+  if(FT_New_Memory_Face(library, reinterpret_cast<unsigned char const *>(buffer.data()), buffer.size(), 0, &face) != 0) { // load face
+    std::cout << "GUIStorm: ERROR: cannot load font " << name << " from " << buffer.size() << " bytes of data" << std::endl;
+    FT_Done_FreeType(library);
+    return false;
+  }
   FT_Select_Charmap(face, FT_ENCODING_UNICODE);                                 // select charmap
   if(suppress_horizontal_hint) {                                                // http://www.antigrain.com/research/font_rasterization/ http://jcgt.org/published/0002/01/04/
     FT_Set_Char_Size(face,
@@ -138,56 +273,10 @@ bool font::load(freetypeglxx::TextureAtlas *font_atlas) {
                      static_cast<FT_UInt>(parent_gui->get_dpi()));              // set char size
     FT_Set_Transform(face, nullptr, nullptr);                                   // set transform matrix - identity
   }
-
-  // cache the overall metrics
-  FT_Size_Metrics const &metrics = face->size->metrics;
-  metrics_ascender  = static_cast<GLfloat>(metrics.ascender  >> 6);
-  metrics_descender = static_cast<GLfloat>(metrics.descender >> 6);
-  metrics_height    = static_cast<GLfloat>(metrics.height    >> 6);
-  metrics_linegap   = metrics_height - metrics_ascender + metrics_descender;
-  #ifdef DEBUG_GUISTORM
-    std::cout << "GUIStorm: Loading font " << name << " (" << memory_size / 1024 << "KB) size " << font_size << " (height " << metrics_height << ", " << glyphs.size() << " glyphs)" << std::endl;
-  #endif // DEBUG_GUISTORM
-
-  // load each glyph
-  if(!load_glyphs(font_atlas, face, charcodes)) {
-    std::cout << "GUIStorm: WARNING: Failed to load all glyphs." << std::endl;
-    return false;
-  }
-
-  // calculate kerning for each glyph pair
-  update_kerning(face);
-
-  FT_Done_Face(face);
-  FT_Done_FreeType(library);
-  return true;
-}
-
-bool font::load_glyphs(freetypeglxx::TextureAtlas *font_atlas,
-                       FT_Face const &face,
-                       #ifdef GUISTORM_NO_UTF
-                         std::string const &codes_to_load) {
-                       #else
-                         std::u32string const &codes_to_load) {
-                       #endif // GUISTORM_NO_UTF
-  /// Load all glyphs specified in a string
-  for(auto const &thischar : codes_to_load) {
-    if(!load_glyph(font_atlas, face, thischar)) {
-      std::cout << "GUIStorm: WARNING: Failed to load glyph \"" << thischar << "\" (ascii " << static_cast<unsigned int>(thischar) << ")" << std::endl;
-      return false;
-    }
-  }
   return true;
 }
-bool font::load_glyph(freetypeglxx::TextureAtlas *font_atlas,
-                      FT_Face const &face,
-                      #ifdef GUISTORM_NO_UTF
-                        char thischar) {
-                      #else
-                        char32_t thischar) {
-                      #endif // GUISTORM_NO_UTF
-  /// Load a glyph specified by one UTF32 codepoint
-  FT_UInt glyph_index = FT_Get_Char_Index(face, thischar);
+FT_Int32 font::get_load_flags() const {
+  /// Return the freetype glyph load flags matching this font's hinting options
   FT_Int32 flags = 0;
   //flags |= FT_LOAD_NO_BITMAP;                                                   // freetype-gl default when using outlines
   flags |= FT_LOAD_RENDER;                                                      // freetype-gl default when using normal rendering
@@ -201,32 +290,180 @@ bool font::load_glyph(freetypeglxx::TextureAtlas *font_atlas,
       flags |= FT_LOAD_NO_HINTING;                                              // freetype-gl default when hinting disabled
     }
   }
+  return flags;
+}
+void font::rasterise_glyph(FT_Face const &face, FT_Int32 flags, rasterised_glyph &thisglyph) const {
+  /// Rasterise a single glyph's bitmap and read its metrics, leaving its kerning to the caller
+  FT_UInt const glyph_index = FT_Get_Char_Index(face, thisglyph.charcode);
   FT_Load_Glyph(face, glyph_index, flags);
+  FT_Bitmap const &ft_bitmap = face->glyph->bitmap;
+  thisglyph.width = ft_bitmap.width;
+  thisglyph.rows  = ft_bitmap.rows;
+  thisglyph.left  = face->glyph->bitmap_left;
+  thisglyph.top   = face->glyph->bitmap_top;
+  thisglyph.bitmap.resize(static_cast<size_t>(ft_bitmap.width) * ft_bitmap.rows);
+  for(unsigned int row = 0; row != ft_bitmap.rows; ++row) {                     // copied out tightly packed, as the face's bitmap is reused for the next glyph
+    std::copy_n(ft_bitmap.buffer + static_cast<ptrdiff_t>(row) * ft_bitmap.pitch, ft_bitmap.width, thisglyph.bitmap.begin() + static_cast<ptrdiff_t>(row) * ft_bitmap.width);
+  }
+  FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_HINTING);                         // discard hinting to get advance - no need to render it again
+  thisglyph.advance.x = static_cast<GLfloat>(face->glyph->advance.x) / hres;
+  thisglyph.advance.y = static_cast<GLfloat>(face->glyph->advance.y) / hres;
+}
+void font::rasterise(size_t first, size_t last) {
+  /// Rasterise a range of this font's glyphs, and work out their kerning after every other glyph
+  /// Safe to call on several threads at once for ranges that don't overlap, as each opens freetype for itself
+  FT_Library library;
+  FT_Face face;
+  if(!open_face(library, face)) {
+    return;
+  }
+
+  if(first == 0) {                                                              // only one range starts at the beginning, so only one thread writes these
+    // cache the overall metrics
+    FT_Size_Metrics const &metrics = face->size->metrics;
+    metrics_ascender  = static_cast<GLfloat>(metrics.ascender  >> 6);
+    metrics_descender = static_cast<GLfloat>(metrics.descender >> 6);
+    metrics_height    = static_cast<GLfloat>(metrics.height    >> 6);
+    metrics_linegap   = metrics_height - metrics_ascender + metrics_descender;
+    #ifdef DEBUG_GUISTORM
+      std::cout << "GUIStorm: Loading font " << name << " (" << buffer.size() / 1024 << "KB) size " << font_size << " (height " << metrics_height << ", " << charcodes.size() << " glyphs)" << std::endl;
+    #endif // DEBUG_GUISTORM
+  }
+
+  FT_Int32 const flags = get_load_flags();
+  bool const has_kerning = FT_HAS_KERNING(face);
+  std::vector<FT_UInt> glyph_indices;                                           // every glyph's index, for kerning against
+  if(has_kerning) {
+    glyph_indices.reserve(charcodes.size());
+    for(auto const &thischar : charcodes) {
+      glyph_indices.emplace_back(FT_Get_Char_Index(face, thischar));
+    }
+  }
+  for(size_t i = first; i != last; ++i) {
+    rasterised_glyph &thisglyph = rasterised[i];
+    rasterise_glyph(face, flags, thisglyph);
+
+    // calculate kerning after each preceding glyph
+    thisglyph.kerning.clear();
+    if(has_kerning) {
+      FT_UInt const glyph_index = FT_Get_Char_Index(face, thisglyph.charcode);
+      for(size_t last_i = 0; last_i != charcodes.size(); ++last_i) {
+        FT_Vector kerning;
+        FT_Get_Kerning(face, glyph_indices[last_i], glyph_index, FT_KERNING_UNFITTED, &kerning);
+        if(kerning.x != 0) {                                                    // missing pairs read as no kerning, so only keep the rest
+          thisglyph.kerning.emplace(charcodes[last_i], static_cast<GLfloat>(kerning.x) / (hres * hres));
+        }
+      }
+    }
+  }
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+}
+#ifdef GUISTORM_LOAD_MISSING_GLYPHS
+#ifdef GUISTORM_NO_UTF
+  bool font::insert_glyph(char charcode) {
+#else
+  bool font::insert_glyph(char32_t charcode) {
+#endif // GUISTORM_NO_UTF
+  /// Rasterise one missing glyph and add it to the live font atlas, without reloading anything else
+  /// Kerning is only worked out for the pairs the new glyph is part of, and only the atlas rows it lands in are uploaded
+  freetypeglxx::TextureAtlas *&font_atlas = parent_gui->font_atlas;
+  if(!font_atlas) {
+    return false;                                                               // nothing's loaded yet, so it'll be loaded along with everything else
+  }
+  if(!live_face && !open_face(live_library, live_face)) {                       // kept open from then on, for the next missing glyph
+    live_face = nullptr;
+    return false;
+  }
+  rasterised_glyph newglyph;
+  newglyph.charcode = charcode;
+  rasterise_glyph(live_face, get_load_flags(), newglyph);
+  if(FT_HAS_KERNING(live_face)) {
+    FT_UInt const glyph_index = FT_Get_Char_Index(live_face, charcode);
+    FT_Vector kerning;
+    FT_Get_Kerning(live_face, glyph_index, glyph_index, FT_KERNING_UNFITTED, &kerning); // after itself
+    if(kerning.x != 0) {
+      newglyph.kerning.emplace(charcode, static_cast<GLfloat>(kerning.x) / (hres * hres));
+    }
+    std::lock_guard lock(glyph_map_mutex);
+    for(auto const &it : glyphs) {
+      FT_UInt const other_index = FT_Get_Char_Index(live_face, it.first);
+      FT_Get_Kerning(live_face, other_index, glyph_index, FT_KERNING_UNFITTED, &kerning); // the new glyph after this one
+      if(kerning.x != 0) {
+        newglyph.kerning.emplace(it.first, static_cast<GLfloat>(kerning.x) / (hres * hres));
+      }
+      FT_Get_Kerning(live_face, glyph_index, other_index, FT_KERNING_UNFITTED, &kerning); // this one after the new glyph
+      if(kerning.x != 0) {
+        it.second->kerning[charcode] = static_cast<GLfloat>(kerning.x) / (hres * hres);
+      }
+    }
+  }
+
+  freetypeglxx::ivec4 region = pack_glyph(font_atlas, newglyph);
+  bool grown = false;
+  while(region.x < 0) {
+    if(!parent_gui->grow_font_atlas()) {
+      return false;
+    }
+    grown = true;
+    region = pack_glyph(font_atlas, newglyph);
+  }
+  charcodes += charcode;                                                        // so it's kept if the fonts are ever rebuilt
+  if(grown) {
+    parent_gui->upload_fonts();                                                 // the texture's changed size, so has to be sent whole
+    parent_gui->refresh();                                                      // every label's quads hold texcoords for the old size, so re-arrange them all
+    parent_gui->damage_all();                                                   // and redraw the whole layer, with any render caches redrawn as they're rebuilt
+  } else {
+    parent_gui->upload_font_rows(region.y, region.w);
+  }
+  return true;
+}
+void font::close_live_face() {
+  /// Close the freetype face kept open for rasterising missing glyphs, if it's open
+  if(!live_face) {
+    return;
+  }
+  FT_Done_Face(live_face);
+  FT_Done_FreeType(live_library);
+  live_face = nullptr;
+  live_library = nullptr;
+}
+#endif // GUISTORM_LOAD_MISSING_GLYPHS
+
+void font::rasterise_end() {
+  /// Free the rasterised glyphs once they've been packed into an atlas for good
+  rasterised.clear();
+  rasterised.shrink_to_fit();
+}
 
-  FT_Bitmap ft_bitmap = face->glyph->bitmap;
+freetypeglxx::ivec4 font::pack_glyph(freetypeglxx::TextureAtlas *font_atlas, rasterised_glyph const &thisglyph, bool warn_full) {
+  /// Pack one rasterised glyph into the atlas, and add it to this font
+  /// Returns the region of the atlas it went in, with a negative x if there was no room
   // We want each glyph to be separated by at least one blank pixel (eg. shader in demo-subpixel.c)
-  vec2<size_t> bitmap_size(ft_bitmap.width / font_atlas->depth() + 1, ft_bitmap.rows + 1);
+  auto const thischar = thisglyph.charcode;
+  vec2<size_t> bitmap_size(thisglyph.width / font_atlas->depth() + 1, thisglyph.rows + 1);
   freetypeglxx::ivec4 region = font_atlas->GetRegion(bitmap_size.x, bitmap_size.y);
   if(region.x < 0) {
-    std::cout << "GUIStorm: WARNING: font load: no room in atlas for font " << name << " at size " << font_size << std::endl;
-    return false;                                                               // we've missed a glyph so drop out early to retry
+    if(warn_full) {
+      std::cout << "GUIStorm: WARNING: font load: no room in atlas for font " << name << " at size " << font_size << std::endl;
+    }
+    return region;                                                              // we've missed a glyph so drop out early to retry
   }
   bitmap_size -= 1;
-  font_atlas->SetRegion(region.x, region.y, bitmap_size.x, bitmap_size.y, ft_bitmap.buffer, ft_bitmap.pitch);
+  font_atlas->SetRegion(region.x, region.y, bitmap_size.x, bitmap_size.y, thisglyph.bitmap.data(), thisglyph.width);
 
   std::shared_ptr<font::glyph> tempglyph(new glyph);
   tempglyph->charcode    = thischar;
-  tempglyph->offset.x    = static_cast<GLfloat>(face->glyph->bitmap_left);
-  tempglyph->offset.y    = static_cast<GLfloat>(face->glyph->bitmap_top) - static_cast<GLfloat>(bitmap_size.y);
+  tempglyph->offset.x    = static_cast<GLfloat>(thisglyph.left);
+  tempglyph->offset.y    = static_cast<GLfloat>(thisglyph.top) - static_cast<GLfloat>(bitmap_size.y);
   tempglyph->size.x      = static_cast<GLfloat>(bitmap_size.x);
   tempglyph->size.y      = static_cast<GLfloat>(bitmap_size.y);
   tempglyph->texcoord0.x = static_cast<GLfloat>( region.x                 ) / static_cast<GLfloat>(font_atlas->width());
   tempglyph->texcoord0.y = static_cast<GLfloat>((region.y + bitmap_size.y)) / static_cast<GLfloat>(font_atlas->height()); // y is flipped for texture coords
   tempglyph->texcoord1.x = static_cast<GLfloat>((region.x + bitmap_size.x)) / static_cast<GLfloat>(font_atlas->width());
   tempglyph->texcoord1.y = static_cast<GLfloat>( region.y                 ) / static_cast<GLfloat>(font_atlas->height()); // y is flipped for texture coords
-  FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);        // discard hinting to get advance
-  tempglyph->advance.x   = static_cast<GLfloat>(face->glyph->advance.x) / hres;
-  tempglyph->advance.y   = static_cast<GLfloat>(face->glyph->advance.y) / hres;
+  tempglyph->advance     = thisglyph.advance;
+  tempglyph->kerning     = thisglyph.kerning;                                   // copied, as we may need packing again into a bigger atlas
 
   #ifdef GUISTORM_NO_UTF
     if(thischar == ' ') {                                                       // if we're drawing whitespace, skip adding the quad - every little helps
@@ -256,8 +493,9 @@ bool font::load_glyph(freetypeglxx::TextureAtlas *font_atlas,
     std::lock_guard lock(glyph_map_mutex);
     glyphs.emplace(thischar, tempglyph);
   }
-  return true;
+  return region;
 }
+#endif // GUISTORM_NO_FREETYPE
 
 void font::unload() {
   /// Unload this font from memory
@@ -266,27 +504,136 @@ void font::unload() {
   glyphs.clear();
 }
 
-void font::update_kerning(FT_Face const &face) {
-  /// Update the kerning between all glyphs
-  for(auto const &this_glyph : glyphs) {
-    update_kerning(face, *this_glyph.second);
+void font::scale_texcoords(coordtype const &scale) {
+  /// Scale every glyph's texcoords, to keep them pointing at the same pixels when the atlas they're in is resized
+  std::lock_guard lock(glyph_map_mutex);
+  for(auto const &it : glyphs) {
+    it.second->texcoord0 *= scale;
+    it.second->texcoord1 *= scale;
   }
 }
-void font::update_kerning(FT_Face const &face, glyph &this_glyph) {
-  /// Update the kerning between this glyph and all others preceding
-  this_glyph.kerning.clear();
-  for(auto const &last_glyph : glyphs) {
-    update_kerning(face, this_glyph, *last_glyph.second);
+
+#ifndef GUISTORM_NO_FREETYPE
+bool font::bake(std::ostream &out, std::string const &identifier) {
+  /// Rasterise this font into an atlas of its own, and write it out as a header of constant data for gui::add_font
+  /// This is what the bake_font tool runs; the atlas is grown until everything fits, then cropped to the glyphs
+  std::unique_ptr<freetypeglxx::TextureAtlas> atlas;
+  rasterise_begin();
+  rasterise(0, charcodes.size());
+  for(size_t atlas_size = 64;; atlas_size *= 2) {
+    if(atlas_size > 8192) {
+      std::cout << "GUIStorm: ERROR: cannot fit font " << name << " at size " << font_size << " in an 8192x8192 atlas to bake it" << std::endl;
+      rasterise_end();
+      return false;
+    }
+    atlas.reset(new freetypeglxx::TextureAtlas(atlas_size, atlas_size, 1));
+    unload();                                                                   // a fresh square atlas each time, to find the smallest that fits
+    if(pack(atlas.get(), false)) {                                              // sizes that don't fit are expected, so not worth a warning
+      break;
+    }
   }
+  rasterise_end();
+  texture_atlas_t const *atlas_self = static_cast<texture_atlas_t const*>(atlas->RawGet());
+  GLfloat const atlas_width  = static_cast<GLfloat>(atlas->width());
+  GLfloat const atlas_height = static_cast<GLfloat>(atlas->height());
+
+  // gather the glyphs in order, so the same font always bakes the same header
+  std::vector<glyph const*> sorted_glyphs;
+  for(auto const &it : glyphs) {
+    sorted_glyphs.emplace_back(it.second.get());
+  }
+  std::sort(sorted_glyphs.begin(), sorted_glyphs.end(), [](glyph const *a, glyph const *b){
+    return a->charcode < b->charcode;
+  });
+  unsigned int crop_width  = 0;                                                 // only keep as much of the atlas as the glyphs cover
+  unsigned int crop_height = 0;
+  for(auto const &thisglyph : sorted_glyphs) {
+    crop_width  = std::max(crop_width,  static_cast<unsigned int>(std::lround(thisglyph->texcoord1.x * atlas_width)));
+    crop_height = std::max(crop_height, static_cast<unsigned int>(std::lround(thisglyph->texcoord0.y * atlas_height)));
+  }
+
+  std::ios_base::fmtflags const flags_old(out.flags());
+  std::streamsize const precision_old(out.precision());
+  out << std::showpoint << std::setprecision(9);                                // enough to give back exactly the same floats
+  std::string name_escaped;
+  for(auto const &thischar : name) {
+    if(thischar == '"' || thischar == '\\') {
+      name_escaped += '\\';
+    }
+    name_escaped += thischar;
+  }
+  out << "#pragma once\n"
+         "\n"
+         "/// " << name << " at " << font_size << "pt, " << parent_gui->get_dpi() << "dpi - baked by bake_font, regenerate rather than editing\n"
+         "\n"
+         "#include <guistorm/baked_font.h>\n"
+         "\n";
+
+  out << "inline constexpr unsigned char " << identifier << "_atlas[] = {";
+  for(unsigned int y = 0; y != crop_height; ++y) {
+    out << "\n ";
+    for(unsigned int x = 0; x != crop_width; ++x) {
+      out << ' ' << static_cast<unsigned int>(atlas_self->data[y * atlas->width() + x]) << ',';
+    }
+  }
+  if(crop_width == 0 || crop_height == 0) {
+    out << "0";                                                                 // arrays can't be empty
+  }
+  out << "\n};\n\n";
+
+  out << "inline constexpr guistorm::baked_font::glyph " << identifier << "_glyphs[] = {\n";
+  std::vector<std::pair<uint32_t, GLfloat>> kerning_pairs;
+  for(auto const &thisglyph : sorted_glyphs) {
+    std::vector<std::pair<uint32_t, GLfloat>> glyph_kerning;
+    for(auto const &it : thisglyph->kerning) {
+      if(it.second != 0.0f) {                                                   // pairs without kerning are left out, and read as zero
+        glyph_kerning.emplace_back(static_cast<uint32_t>(it.first), it.second);
+      }
+    }
+    std::sort(glyph_kerning.begin(), glyph_kerning.end());
+    out << "  {0x" << std::hex << static_cast<uint32_t>(thisglyph->charcode) << std::dec << ", "
+        << (thisglyph->is_blank ? "true" : "false") << ", "
+        << (thisglyph->linebreak ? "true" : "false") << ", "
+        << std::lround(thisglyph->texcoord0.x * atlas_width) << ", "
+        << std::lround(thisglyph->texcoord1.y * atlas_height) << ", "
+        << "{" << thisglyph->offset.x  << "f, " << thisglyph->offset.y  << "f}, "
+        << "{" << thisglyph->size.x    << "f, " << thisglyph->size.y    << "f}, "
+        << "{" << thisglyph->advance.x << "f, " << thisglyph->advance.y << "f}, "
+        << kerning_pairs.size() << ", " << glyph_kerning.size() << "},\n";
+    kerning_pairs.insert(kerning_pairs.end(), glyph_kerning.begin(), glyph_kerning.end());
+  }
+  out << "};\n\n";
+
+  out << "inline constexpr guistorm::baked_font::kerning_pair " << identifier << "_kerning[] = {\n";
+  for(auto const &it : kerning_pairs) {
+    out << "  {0x" << std::hex << it.first << std::dec << ", " << it.second << "f},\n";
+  }
+  if(kerning_pairs.empty()) {
+    out << "  {0, 0.0f}\n";                                                     // arrays can't be empty
+  }
+  out << "};\n\n";
+
+  out << "inline constexpr guistorm::baked_font " << identifier << "{\n"
+         "  \"" << name_escaped << "\",\n"
+         "  " << font_size << "f,\n"
+         "  " << parent_gui->get_dpi() << "f,\n"
+         "  " << metrics_ascender  << "f,\n"
+         "  " << metrics_descender << "f,\n"
+         "  " << metrics_height    << "f,\n"
+         "  " << metrics_linegap   << "f,\n"
+         "  " << crop_width  << ",\n"
+         "  " << crop_height << ",\n"
+         "  " << identifier << "_atlas,\n"
+         "  " << identifier << "_glyphs,\n"
+         "  " << sorted_glyphs.size() << ",\n"
+         "  " << identifier << "_kerning,\n"
+         "  " << kerning_pairs.size() << "\n"
+         "};\n";
+  out.flags(flags_old);
+  out.precision(precision_old);
+  return static_cast<bool>(out);
 }
-void font::update_kerning(FT_Face const &face, glyph &this_glyph, glyph const &last_glyph) {
-  /// Update the kerning between two glyphs
-  FT_UInt glyph_index = FT_Get_Char_Index(face, this_glyph.charcode);
-  FT_UInt prev_index  = FT_Get_Char_Index(face, last_glyph.charcode);
-  FT_Vector kerning;
-  FT_Get_Kerning(face, prev_index, glyph_index, FT_KERNING_UNFITTED, &kerning);
-  this_glyph.kerning.emplace(last_glyph.charcode, static_cast<GLfloat>(kerning.x) / (hres * hres));
-}
+#endif // GUISTORM_NO_FREETYPE
 
 #ifdef GUISTORM_NO_UTF
   std::shared_ptr<font::glyph> const font::getglyph(char charcode) {
@@ -298,16 +645,19 @@ void font::update_kerning(FT_Face const &face, glyph &this_glyph, glyph const &l
   try {
     tempglyph = glyphs.at(charcode);
   } catch(std::out_of_range const &e) {
-    #ifdef GUISTORM_LOAD_MISSING_GLYPHS
+    #if defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_FREETYPE)
+      if(baked) {
+        std::cout << "GUIStorm: WARNING: baked font " << name << " has no glyph for character \"" << charcode << "\" (ascii " << static_cast<unsigned int>(charcode) << ")" << std::endl;
+        return tempglyph;                                                       // only what was baked can be drawn
+      }
       std::cout << "GUIStorm: loading glyph for character \"" << charcode << "\" (ascii " << static_cast<unsigned int>(charcode) << ")" << std::endl;
-      ///unload();
-      ///__sync_synchronize();                                                    // memory barrier
-      charcodes += charcode;
-      parent_gui->load_fonts();                                                 // request a full font reload - expensive!
-      tempglyph = glyphs[charcode];
+      if(insert_glyph(charcode)) {                                              // just this glyph, into the atlas as it is
+        std::lock_guard lock(glyph_map_mutex);
+        tempglyph = glyphs[charcode];
+      }
     #else
       std::cout << "GUIStorm: WARNING: could not fetch glyph for character \"" << charcode << "\" (ascii " << static_cast<unsigned int>(charcode) << ")" << std::endl;
-    #endif // GUISTORM_LOAD_MISSING_GLYPHS
+    #endif // defined(GUISTORM_LOAD_MISSING_GLYPHS) && !defined(GUISTORM_NO_FREETYPE)
   }
   return tempglyph;
 }
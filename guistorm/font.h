@@ -6,9 +6,15 @@
   #include <unordered_map>
   #include <mutex>
   #include <memory>
-  #include <ft2build.h>
-  #include FT_FREETYPE_H
-  #include <freetype-gl++/freetype-gl++.hpp>
+  #ifdef GUISTORM_NO_FREETYPE
+    #include <freetype-gl++/texture-atlas.hpp>
+  #else
+    #include <ostream>
+    #include <ft2build.h>
+    #include FT_FREETYPE_H
+    #include <freetype-gl++/freetype-gl++.hpp>
+  #endif // GUISTORM_NO_FREETYPE
+  #include "baked_font.h"
   #include "types.h"
 #endif // GUISTORM_NO_TEXT
 
@@ -21,10 +27,12 @@ class gui;
 #else
 class font {
   /// Container class to hold a font object and metadata about it
+  friend class font_cache;
 public:
   struct glyph {
     /// Container for the dimensions of glyph rectangles and their texcoords
     friend class font;
+    friend class font_cache;
     #ifdef GUISTORM_NO_UTF
       char charcode = '\0';                                                     // what character this glyph represents (ascii)
     #else
@@ -73,9 +81,32 @@ private:
     std::unordered_map<char32_t, std::shared_ptr<glyph>> glyphs;                // library of unicode glyphs
   #endif // GUISTORM_NO_UTF
   mutable std::mutex glyph_map_mutex;                                           // mutex to prevent glyphs being modified while being read
+  #ifndef GUISTORM_NO_FREETYPE
+    struct rasterised_glyph {
+      /// A glyph's bitmap and metrics straight out of freetype, waiting to be packed into an atlas
+      #ifdef GUISTORM_NO_UTF
+        char charcode = '\0';
+      #else
+        char32_t charcode = U'\0';
+      #endif // GUISTORM_NO_UTF
+      std::vector<unsigned char> bitmap;                                        // tightly packed rows of coverage
+      unsigned int width = 0;                                                   // width of the bitmap in bytes
+      unsigned int rows  = 0;
+      int left = 0;                                                             // bearing from the pen to the bitmap
+      int top  = 0;
+      coordtype advance;
+      decltype(glyph::kerning) kerning;                                         // non-zero kerning after each preceding character
+    };
+    std::vector<rasterised_glyph> rasterised;                                   // glyphs rasterised but not yet packed, one per charcode
+    #ifdef GUISTORM_LOAD_MISSING_GLYPHS
+      FT_Library live_library = nullptr;
+      FT_Face live_face = nullptr;                                              // kept open to rasterise glyphs missing from the atlas as they're asked for
+    #endif // GUISTORM_LOAD_MISSING_GLYPHS
+  #endif // GUISTORM_NO_FREETYPE
 public:
   std::string name;
   std::string_view buffer;                                                      // offset and size in memory of the raw font data
+  baked_font const *baked = nullptr;                                            // glyphs rasterised ahead of time to load instead of the raw font data, if any
   float font_size = 0;                                                          // font size to load this font at, in points
   GLfloat metrics_ascender  = 0.0;
   GLfloat metrics_descender = 0.0;
@@ -106,22 +137,39 @@ public:
         std::u32string const &charcodes_to_load = U"",
        #endif // GUISTORM_NO_UTF
        bool suppress_horizontal_hint = true);
+  font(gui *parent_gui,
+       baked_font const &baked);
   ~font();
 
   bool load_if_needed(freetypeglxx::TextureAtlas *font_atlas);
   bool load(freetypeglxx::TextureAtlas *font_atlas);
-  #ifdef GUISTORM_NO_UTF
-    bool load_glyphs(freetypeglxx::TextureAtlas *font_atlas, FT_Face const &face, std::string const &charcodes);
-    bool load_glyph( freetypeglxx::TextureAtlas *font_atlas, FT_Face const &face, char charcode);
-  #else
-    bool load_glyphs(freetypeglxx::TextureAtlas *font_atlas, FT_Face const &face, std::u32string const &charcodes);
-    bool load_glyph( freetypeglxx::TextureAtlas *font_atlas, FT_Face const &face, char32_t charcode);
-  #endif // GUISTORM_NO_UTF
+  bool load_baked(freetypeglxx::TextureAtlas *font_atlas);
+  bool pack(freetypeglxx::TextureAtlas *font_atlas, bool warn_full = true);
+  #ifndef GUISTORM_NO_FREETYPE
+    void rasterise_begin();
+    void rasterise(size_t first, size_t last);
+    void rasterise_end();
+  private:
+    bool open_face(FT_Library &library, FT_Face &face) const;
+    FT_Int32 get_load_flags() const __attribute__((__pure__));
+    void rasterise_glyph(FT_Face const &face, FT_Int32 flags, rasterised_glyph &thisglyph) const;
+    freetypeglxx::ivec4 pack_glyph(freetypeglxx::TextureAtlas *font_atlas, rasterised_glyph const &thisglyph, bool warn_full = true);
+    #ifdef GUISTORM_LOAD_MISSING_GLYPHS
+      #ifdef GUISTORM_NO_UTF
+        bool insert_glyph(char charcode);
+      #else
+        bool insert_glyph(char32_t charcode);
+      #endif // GUISTORM_NO_UTF
+      void close_live_face();
+    #endif // GUISTORM_LOAD_MISSING_GLYPHS
+  public:
+  #endif // GUISTORM_NO_FREETYPE
   void unload();
+  void scale_texcoords(coordtype const &scale);
 
-  void update_kerning(FT_Face const &face);
-  void update_kerning(FT_Face const &face, glyph &first);
-  void update_kerning(FT_Face const &face, glyph &first, glyph const &second);
+  #ifndef GUISTORM_NO_FREETYPE
+    bool bake(std::ostream &out, std::string const &identifier);
+  #endif // GUISTORM_NO_FREETYPE
 
   #ifdef GUISTORM_NO_UTF
     std::shared_ptr<font::glyph> const getglyph(char charcode);
@@ -0,0 +1,236 @@
+#ifndef GUISTORM_NO_TEXT
+
+#include "font_cache.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <freetype-gl/texture-atlas.h>
+#include "gui.h"
+
+namespace guistorm {
+
+uint64_t font_cache::get_key(std::vector<font*> const &fonts, float dpi, size_t atlas_depth) {
+  /// Hash everything the atlas is built from, so a cache is only used while it still matches
+  uint64_t hash = 0xcbf29ce484222325ull;                                        // 64 bit FNV-1a offset basis
+  auto const add = [&hash](void const *data, size_t size){
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for(size_t i = 0; i != size; ++i) {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ull;                                                 // 64 bit FNV prime
+    }
+  };
+  uint64_t const depth = atlas_depth;
+  uint64_t const font_count = fonts.size();
+  add(&version,    sizeof(version));
+  add(&dpi,        sizeof(dpi));
+  add(&depth,      sizeof(depth));
+  add(&font_count, sizeof(font_count));
+  for(auto const &thisfont : fonts) {
+    uint64_t const buffer_size = thisfont->buffer.size();
+    add(&buffer_size, sizeof(buffer_size));
+    add(thisfont->buffer.data(), thisfont->buffer.size());                      // the font itself, in case it's been updated under the same name
+    if(thisfont->baked) {
+      baked_font const &baked = *thisfont->baked;
+      add(baked.atlas,   static_cast<size_t>(baked.atlas_width) * baked.atlas_height);
+      add(baked.glyphs,  baked.glyph_count   * sizeof(baked_font::glyph));
+      add(baked.kerning, baked.kerning_count * sizeof(baked_font::kerning_pair));
+    }
+    add(&thisfont->font_size, sizeof(thisfont->font_size));
+    uint8_t const hinting[] = {thisfont->force_autohint,
+                               thisfont->suppress_horizontal_hint,
+                               thisfont->suppress_autohunt,
+                               thisfont->suppress_hinting};
+    add(hinting, sizeof(hinting));
+    uint64_t const charcodes_size = thisfont->charcodes.size();
+    add(&charcodes_size, sizeof(charcodes_size));
+    add(thisfont->charcodes.data(), thisfont->charcodes.size() * sizeof(thisfont->charcodes[0]));
+  }
+  return hash;
+}
+
+bool font_cache::load(std::string const &path, gui &parent_gui) {
+  /// Load the font atlas and every font's glyphs from the cache file, if it matches the gui's current fonts
+  /// Returns false without changing anything if there's no usable cache, for the atlas to be built as usual
+  std::ifstream file(path, std::ios::binary);
+  if(!file) {
+    return false;                                                               // nothing cached yet
+  }
+  std::vector<font*> const &fonts = parent_gui.fonts;
+  header file_header;
+  if(!file.read(reinterpret_cast<char*>(&file_header), sizeof(file_header)) ||
+     file_header.magic      != magic   ||
+     file_header.version    != version ||
+     file_header.font_count != fonts.size() ||
+     file_header.key        != get_key(fonts, parent_gui.get_dpi(), file_header.atlas_depth)) {
+    std::cout << "GUIStorm: Font cache " << path << " doesn't match the fonts loaded, rebuilding" << std::endl;
+    return false;
+  }
+  GLint const maxtexture = parent_gui.get_backend().get_max_texture_size();
+  if(file_header.atlas_width  == 0 || file_header.atlas_width  > static_cast<uint32_t>(maxtexture) ||
+     file_header.atlas_height == 0 || file_header.atlas_height > static_cast<uint32_t>(maxtexture) ||
+     file_header.atlas_depth  == 0 || file_header.atlas_depth  > 4 ||
+     file_header.node_count   == 0 || file_header.node_count   > file_header.atlas_width) {
+    std::cout << "GUIStorm: WARNING: font cache " << path << " has an unusable " << file_header.atlas_width << "x" << file_header.atlas_height << " atlas, rebuilding" << std::endl;
+    return false;
+  }
+
+  // read everything into fresh storage first, so a damaged file leaves the fonts as they were
+  std::unique_ptr<freetypeglxx::TextureAtlas> atlas(new freetypeglxx::TextureAtlas(file_header.atlas_width, file_header.atlas_height, file_header.atlas_depth));
+  texture_atlas_t *atlas_self = static_cast<texture_atlas_t*>(atlas->RawGet());
+  bool valid = static_cast<bool>(file.read(reinterpret_cast<char*>(atlas_self->data),
+                                           static_cast<std::streamsize>(file_header.atlas_width) * file_header.atlas_height * file_header.atlas_depth)); // straight into the atlas's own bitmap
+  std::vector<node_record> nodes(file_header.node_count);
+  valid = valid && file.read(reinterpret_cast<char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(node_record)));
+  int64_t node_end = 1;                                                         // the packer's skyline starts after a pixel's margin
+  for(size_t i = 0; valid && i != nodes.size(); ++i) {
+    valid = nodes[i].x     == node_end &&                                       // each node starts where the last one ended
+            nodes[i].width >  0 &&
+            nodes[i].y     >= 0 && static_cast<uint32_t>(nodes[i].y) <= file_header.atlas_height;
+    node_end = static_cast<int64_t>(nodes[i].x) + nodes[i].width;
+  }
+  valid = valid &&
+          node_end == static_cast<int64_t>(file_header.atlas_width) - 1 &&      // and ends a pixel short of the far edge
+          file_header.atlas_used <= static_cast<uint64_t>(file_header.atlas_width) * file_header.atlas_height;
+  std::vector<font_record> font_records(fonts.size());
+  std::vector<std::vector<std::shared_ptr<font::glyph>>> font_glyphs(fonts.size());
+  for(size_t i = 0; valid && i != fonts.size(); ++i) {
+    valid = static_cast<bool>(file.read(reinterpret_cast<char*>(&font_records[i]), sizeof(font_record))) &&
+            font_records[i].glyph_count <= fonts[i]->charcodes.size();
+    for(uint32_t g = 0; valid && g != font_records[i].glyph_count; ++g) {
+      glyph_record record;
+      valid = static_cast<bool>(file.read(reinterpret_cast<char*>(&record), sizeof(record))) &&
+              record.kerning_count <= font_records[i].glyph_count;
+      if(!valid) {
+        break;
+      }
+      std::shared_ptr<font::glyph> thisglyph(new font::glyph);
+      thisglyph->charcode  = static_cast<decltype(thisglyph->charcode)>(record.charcode);
+      thisglyph->is_blank  = record.is_blank  != 0;
+      thisglyph->linebreak = record.linebreak != 0;
+      thisglyph->offset    = coordtype(record.offset[0],    record.offset[1]);
+      thisglyph->size      = coordtype(record.size[0],      record.size[1]);
+      thisglyph->texcoord0 = coordtype(record.texcoord0[0], record.texcoord0[1]);
+      thisglyph->texcoord1 = coordtype(record.texcoord1[0], record.texcoord1[1]);
+      thisglyph->advance   = coordtype(record.advance[0],   record.advance[1]);
+      for(uint32_t k = 0; valid && k != record.kerning_count; ++k) {
+        kerning_record kerning;
+        valid = static_cast<bool>(file.read(reinterpret_cast<char*>(&kerning), sizeof(kerning)));
+        thisglyph->kerning.emplace(static_cast<decltype(thisglyph->charcode)>(kerning.charcode_last), kerning.kerning);
+      }
+      font_glyphs[i].emplace_back(thisglyph);
+    }
+  }
+  if(!valid) {
+    std::cout << "GUIStorm: WARNING: font cache " << path << " is damaged or incomplete, rebuilding" << std::endl;
+    return false;
+  }
+
+  // everything's read, so swap it in
+  vector_clear(atlas_self->nodes);                                              // the packer carries on from where it was, for any glyphs added later
+  for(auto const &node : nodes) {
+    int const thisnode[3] = {node.x, node.y, node.width};                       // laid out as freetype-gl's ivec3 x, y, width
+    vector_push_back(atlas_self->nodes, thisnode);
+  }
+  atlas_self->used = file_header.atlas_used;
+  for(size_t i = 0; i != fonts.size(); ++i) {
+    font &thisfont = *fonts[i];
+    thisfont.unload();
+    thisfont.metrics_ascender  = font_records[i].metrics_ascender;
+    thisfont.metrics_descender = font_records[i].metrics_descender;
+    thisfont.metrics_height    = font_records[i].metrics_height;
+    thisfont.metrics_linegap   = font_records[i].metrics_linegap;
+    std::lock_guard lock(thisfont.glyph_map_mutex);
+    for(auto const &thisglyph : font_glyphs[i]) {
+      thisfont.glyphs.emplace(thisglyph->charcode, thisglyph);
+    }
+  }
+  delete parent_gui.font_atlas;
+  parent_gui.font_atlas = atlas.release();
+  std::cout << "GUIStorm: Loaded " << fonts.size() << " fonts to " << file_header.atlas_width << "x" << file_header.atlas_height << " atlas from cache " << path << std::endl;
+  return true;
+}
+
+bool font_cache::save(std::string const &path, gui &parent_gui) {
+  /// Write the gui's font atlas and every font's glyphs to the cache file, replacing any there
+  /// Written to a temporary file first and renamed into place, so a reader never finds half a cache
+  freetypeglxx::TextureAtlas const *atlas = parent_gui.font_atlas;
+  if(!atlas) {
+    return false;
+  }
+  std::vector<font*> const &fonts = parent_gui.fonts;
+  std::string const path_temp(path + ".tmp");
+  {
+    std::ofstream file(path_temp, std::ios::binary | std::ios::trunc);
+    if(!file) {
+      std::cout << "GUIStorm: WARNING: cannot write font cache to " << path_temp << std::endl;
+      return false;
+    }
+    texture_atlas_t const *atlas_self = static_cast<texture_atlas_t const*>(const_cast<freetypeglxx::TextureAtlas*>(atlas)->RawGet());
+    header const file_header{magic,
+                             version,
+                             get_key(fonts, parent_gui.get_dpi(), atlas->depth()),
+                             static_cast<uint32_t>(atlas->width()),
+                             static_cast<uint32_t>(atlas->height()),
+                             static_cast<uint32_t>(atlas->depth()),
+                             static_cast<uint32_t>(fonts.size()),
+                             static_cast<uint32_t>(vector_size(atlas_self->nodes)),
+                             static_cast<uint32_t>(atlas_self->used)};
+    file.write(reinterpret_cast<char const*>(&file_header), sizeof(file_header));
+    file.write(reinterpret_cast<char const*>(atlas_self->data), static_cast<std::streamsize>(atlas->width() * atlas->height() * atlas->depth()));
+    for(size_t i = 0; i != vector_size(atlas_self->nodes); ++i) {
+      int const *thisnode = static_cast<int const*>(vector_get(atlas_self->nodes, i)); // freetype-gl's ivec3 x, y, width
+      node_record const node{thisnode[0], thisnode[1], thisnode[2]};
+      file.write(reinterpret_cast<char const*>(&node), sizeof(node));
+    }
+    for(auto const &thisfont : fonts) {
+      std::lock_guard lock(thisfont->glyph_map_mutex);
+      font_record const record{thisfont->metrics_ascender,
+                               thisfont->metrics_descender,
+                               thisfont->metrics_height,
+                               thisfont->metrics_linegap,
+                               static_cast<uint32_t>(thisfont->glyphs.size())};
+      file.write(reinterpret_cast<char const*>(&record), sizeof(record));
+      for(auto const &it : thisfont->glyphs) {
+        font::glyph const &thisglyph = *it.second;
+        glyph_record const record{static_cast<uint32_t>(thisglyph.charcode),
+                                  thisglyph.is_blank,
+                                  thisglyph.linebreak,
+                                  {0, 0},
+                                  {static_cast<float>(thisglyph.offset.x),    static_cast<float>(thisglyph.offset.y)},
+                                  {static_cast<float>(thisglyph.size.x),      static_cast<float>(thisglyph.size.y)},
+                                  {static_cast<float>(thisglyph.texcoord0.x), static_cast<float>(thisglyph.texcoord0.y)},
+                                  {static_cast<float>(thisglyph.texcoord1.x), static_cast<float>(thisglyph.texcoord1.y)},
+                                  {static_cast<float>(thisglyph.advance.x),   static_cast<float>(thisglyph.advance.y)},
+                                  static_cast<uint32_t>(thisglyph.kerning.size())};
+        file.write(reinterpret_cast<char const*>(&record), sizeof(record));
+        for(auto const &kerning_it : thisglyph.kerning) {
+          kerning_record const kerning{static_cast<uint32_t>(kerning_it.first), kerning_it.second};
+          file.write(reinterpret_cast<char const*>(&kerning), sizeof(kerning));
+        }
+      }
+    }
+    if(!file) {
+      std::cout << "GUIStorm: WARNING: failed writing font cache to " << path_temp << std::endl;
+      file.close();
+      std::remove(path_temp.c_str());
+      return false;
+    }
+  }
+  if(std::rename(path_temp.c_str(), path.c_str()) != 0) {
+    std::remove(path.c_str());                                                  // some platforms won't rename over an existing file
+    if(std::rename(path_temp.c_str(), path.c_str()) != 0) {
+      std::cout << "GUIStorm: WARNING: cannot replace font cache " << path << std::endl;
+      std::remove(path_temp.c_str());
+      return false;
+    }
+  }
+  #ifdef DEBUG_GUISTORM
+    std::cout << "GUIStorm: Saved " << fonts.size() << " fonts to font cache " << path << std::endl;
+  #endif // DEBUG_GUISTORM
+  return true;
+}
+
+}
+
+#endif // GUISTORM_NO_TEXT
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef GUISTORM_NO_TEXT
+  #include <cstdint>
+  #include <string>
+  #include <vector>
+#endif // GUISTORM_NO_TEXT
+
+namespace guistorm {
+
+#ifndef GUISTORM_NO_TEXT
+class gui;
+class font;
+
+class font_cache {
+  /// Saves the gui's packed font atlas and its packer state, with every font's
+  /// metrics, glyphs and kerning, to a file, so later runs can load it straight back instead of
+  /// rasterising everything with freetype again.  The file is keyed by a hash
+  /// of everything that goes into the atlas - each font's data, size and
+  /// hinting, the glyphs it loads, and the dpi - so any change rebuilds it.
+  /// Multi-byte values are stored in native byte order, so a cache is only
+  /// reused on the platform it was written on.
+  static uint32_t constexpr magic   = 0x43465347;                               // "GSFC", which also fails to match if read with the wrong byte order
+  static uint32_t constexpr version = 2;                                        // bump whenever the layout changes
+
+  struct header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;                                                               // hash of everything the atlas was built from
+    uint32_t atlas_width;
+    uint32_t atlas_height;
+    uint32_t atlas_depth;
+    uint32_t font_count;
+    uint32_t node_count;                                                        // entries in the atlas packer's skyline
+    uint32_t atlas_used;                                                        // area of the atlas the packer has handed out
+  };
+  struct node_record {
+    /// One segment of the atlas packer's skyline, so glyphs can still be added to a cached atlas
+    int32_t x;
+    int32_t y;
+    int32_t width;
+  };
+  struct font_record {
+    float metrics_ascender;
+    float metrics_descender;
+    float metrics_height;
+    float metrics_linegap;
+    uint32_t glyph_count;
+  };
+  struct glyph_record {
+    uint32_t charcode;
+    uint8_t is_blank;
+    uint8_t linebreak;
+    uint8_t padding[2];
+    float offset[2];
+    float size[2];
+    float texcoord0[2];
+    float texcoord1[2];
+    float advance[2];
+    uint32_t kerning_count;
+  };
+  struct kerning_record {
+    uint32_t charcode_last;                                                     // the preceding character
+    float kerning;
+  };
+
+public:
+  static uint64_t get_key(std::vector<font*> const &fonts, float dpi, size_t atlas_depth) __attribute__((__pure__));
+  static bool load(std::string const &path, gui &parent_gui);
+  static bool save(std::string const &path, gui &parent_gui);
+};
+#endif // GUISTORM_NO_TEXT
+
+}
@@ -1,5 +1,4 @@
 #include "graph_line.h"
-#include "cast_if_required.h"
 #include "gui.h"
 
 namespace guistorm {
@@ -20,41 +19,13 @@ graph_line::~graph_line() {
   /// Default destructor
 }
 
-void graph_line::init_buffer() {
-  /// Generate the buffers for this object
-  glGenBuffers(1, &vbo);
-  glGenBuffers(1, &vbo_fill);
-  glGenBuffers(1, &ibo);
-  glGenBuffers(1, &ibo_fill);
-}
-void graph_line::destroy_buffer() {
-  /// Clean up the buffers in preparation for exit or context switch
-  glDeleteBuffers(1, &vbo);
-  glDeleteBuffers(1, &vbo_fill);
-  glDeleteBuffers(1, &ibo);
-  glDeleteBuffers(1, &ibo_fill);
-  vbo           = 0;
-  vbo_fill      = 0;
-  ibo           = 0;
-  ibo_fill      = 0;
-  numverts      = 0;
-  numverts_fill = 0;
-  initialised = false;
-}
-
 void graph_line::setup_buffer() {
-  /// Create or update the buffer for this element
-  if(__builtin_expect(vbo == 0, 0)) {                                           // if the buffer hasn't been generated yet (unlikely)
-    init_buffer();
-  }
-  coordtype const position_absolute(get_absolute_position());
-  std::vector<vertex> vbodata;
-  std::vector<GLuint> ibodata;
+  /// Create or update the cached geometry for this element, relative to its origin
   #ifndef GUISTORM_SINGLETHREADED
     std::shared_lock lock(data_mutex);                                          // lock for reading (shared)
   #endif // GUISTORM_SINGLETHREADED
-  vbodata.reserve(data.size());
-  ibodata.reserve(data.size());
+  line_points.clear();
+  line_points.reserve(data.size());
 
   float const xstep = size.x / static_cast<float>(data.size());
   float vertical_scale;
@@ -63,75 +34,35 @@ void graph_line::setup_buffer() {
   } else {
     vertical_scale = size.y / (max - min);
   }
-  float x = position_absolute.x;
+  float x = 0.0f;
   for(auto const &it : data) {
-    ibodata.emplace_back(vbodata.size());
-    float const val = position_absolute.y + std::clamp((it - min) * vertical_scale, 0.0f, size.y);
-    vbodata.emplace_back(parent_gui->coord_transform(coordtype(x, val)));
+    float const val = std::clamp((it - min) * vertical_scale, 0.0f, size.y);
+    line_points.emplace_back(x, val);
     x += xstep;
     // TODO: populate the fill buffer
   }
   #ifndef GUISTORM_SINGLETHREADED
     lock.unlock();
   #endif // GUISTORM_SINGLETHREADED
-  numverts = cast_if_required<GLuint>(ibodata.size());
-
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-  glBufferData(GL_ARRAY_BUFFER,         vbodata.size() * sizeof(vertex), &vbodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-  #endif // GUISTORM_UNBIND
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, numverts       * sizeof(GLuint), &ibodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  #endif // GUISTORM_UNBIND
-
-  initialised = true;
 }
 
 void graph_line::render() {
-  /// Draw this element
+  /// Submit this element's geometry to the gui's batch renderer
   if(!visible) {
     return;
   }
-  if(__builtin_expect(!initialised, 0)) {                                       // if the buffer hasn't been initialised yet (unlikely)
-    setup_buffer();
-  }
-  if(numverts != 0) {
-    if(colours.current.background.a != 0.0f) {                                  // skip drawing fully transparent parts
-      glBindBuffer(GL_ARRAY_BUFFER,         vbo_fill);
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_fill);
-      glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-      glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-      glUniform4f(parent_gui->uniform_colour,
-                  colours.current.background.r,
-                  colours.current.background.g,
-                  colours.current.background.b,
-                  colours.current.background.a);
-      glDrawElements(GL_TRIANGLES, numverts_fill, GL_UNSIGNED_INT, 0);          // fill under the line
-    }
-    if(colours.current.content.a != 0.0f) {                                     // skip drawing fully transparent parts
-      glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-      glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-      glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-      glUniform4f(parent_gui->uniform_colour,
-                  colours.current.content.r,
-                  colours.current.content.g,
-                  colours.current.content.b,
-                  colours.current.content.a);
-      glDrawElements(GL_LINE_STRIP, numverts, GL_UNSIGNED_INT, 0);              // line
-    }
+  coordtype const origin(get_absolute_position());
+  if(cull(origin)) {
+    return;
   }
-
-  update();
+  track_damage(origin);
+  parent_gui->current_batch->add_line_strip(line_points, origin, colours.get_paint_content()); // line
 }
 
 void graph_line::set_min(float new_min) {
   if(min != new_min) {
     min = new_min;
-    initialised = false;                                                        // mark the buffer as needing a refresh
+    invalidate(dirty_geometry);                                                 // mark the buffer as needing a refresh
   }
 }
 float const &graph_line::get_min() const {
@@ -140,7 +71,7 @@ float const &graph_line::get_min() const {
 void graph_line::set_max(float new_max) {
   if(max != new_max) {
     max = new_max;
-    initialised = false;                                                        // mark the buffer as needing a refresh
+    invalidate(dirty_geometry);                                                 // mark the buffer as needing a refresh
   }
 }
 float const &graph_line::get_max() const {
@@ -13,9 +13,7 @@ namespace guistorm {
 class graph_line : public base {
   /// A horizontal line graph populated from an iteraterable container
 private:
-  GLuint vbo_fill = 0;                                                          // vertex buffer for the fill, in format compatible with GL_TRIANGLES
-  GLuint ibo_fill = 0;                                                          // index buffer for the fill
-  GLuint numverts_fill = 0;                                                     // number of vertices in the fill buffer
+  std::vector<coordtype> line_points;                                           // cached points of the line in pixels relative to the origin
 
   float min = 0.0;                                                              // the minimum value shown on the graph
   float max = 1.0;                                                              // the maximum value shown on the graph
@@ -36,10 +34,8 @@ protected:
   virtual ~graph_line() override;
 
 public:
-  void init_buffer()    override final;
-  void destroy_buffer() override final;
-  void setup_buffer()   override final;
-  void render()         override final;
+  void setup_buffer() override final;
+  void render()       override final;
 
   void set_min(float new_min);
   float const &get_min() const __attribute__((__const__));
@@ -62,7 +58,7 @@ template<typename T> void graph_line::upload(T const &begin, T const &end) {
   for(auto const &it : boost::make_iterator_range(begin, end)) {
     data.emplace_back(it);
   }
-  initialised = false;                                                          // mark the buffer as needing a refresh
+  invalidate(dirty_geometry);                                                   // mark the buffer as needing a refresh
 }
 
 }
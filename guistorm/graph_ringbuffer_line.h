@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base.h"
+#include <vector>
 #ifndef GUISTORM_SINGLETHREADED
   #include <shared_mutex>
 #endif // GUISTORM_SINGLETHREADED
@@ -11,9 +12,7 @@ namespace guistorm {
 class graph_ringbuffer_line : public base {
   /// A horizontal line graph populated from an iteraterable container
 private:
-  GLuint vbo_fill = 0;                                                          // vertex buffer for the fill, in format compatible with GL_TRIANGLES
-  GLuint ibo_fill = 0;                                                          // index buffer for the fill
-  GLuint numverts_fill = 0;                                                     // number of vertices in the fill buffer
+  std::vector<coordtype> line_points;                                           // cached points of the line in pixels relative to the origin
 
   float min = 0.0;                                                              // the minimum value shown on the graph
   float max = 1.0;                                                              // the maximum value shown on the graph
@@ -35,10 +34,8 @@ protected:
   virtual ~graph_ringbuffer_line() override;
 
 public:
-  void init_buffer()    override final;
-  void destroy_buffer() override final;
-  void setup_buffer()   override final;
-  void render()         override final;
+  void setup_buffer() override final;
+  void render()       override final;
 
   void set_min(float new_min);
   float const &get_min() const __attribute__((__const__));
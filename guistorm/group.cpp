@@ -10,7 +10,9 @@ group::group(container *newparent,
   /// Specific constructor
   focusable = false;
   #ifdef DEBUG_GUISTORM
-    colours.idle.outline.assign(0.0, 0.0, 1.0, 1.0);                            // draw a coloured outline for layout debugging purposes: yellow
+    palette debug_palette(get_palette());
+    debug_palette.idle.outline.assign(0.0, 0.0, 1.0, 1.0);                      // draw a coloured outline for layout debugging purposes: yellow
+    set_palette(palette::intern(debug_palette));
   #endif // DEBUG_GUISTORM
 }
 
@@ -25,22 +27,18 @@ base *group::get_picked(coordtype const &cursor_position) {
   }
   return container::get_picked(cursor_position);                                // bypass the window checking and don't return this if we miss any child objects
 }
+bool group::is_pick_target() const {
+  /// Groups are never picked themselves, only their children
+  return false;
+}
+bool group::clips_picking() const {
+  /// Groups have no area of their own, so don't restrict picking their children
+  return false;
+}
 
 #ifndef DEBUG_GUISTORM
-  void group::init_buffer() {
-    /// noop since nothing is drawn
-  }
-  void group::destroy_buffer() {
-    /// noop since nothing is drawn
-    initialised = false;
-    container::destroy_buffer();
-  }
-
   void group::setup_buffer() {
-    /// Create or update the buffer for this element
-    numverts = 0;                                                               // mark the outline and fill buffer as unused
-    // skip initialising any visible content
-    initialised = true;
+    /// noop since nothing is drawn
   }
 
   void group::render() {
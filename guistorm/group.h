@@ -16,10 +16,10 @@ protected:
 
 public:
   base *get_picked(coordtype const &cursor_position) override final;
+  bool is_pick_target() const override final __attribute__((__const__));
+  bool clips_picking() const override final __attribute__((__const__));
 
   #ifndef DEBUG_GUISTORM
-    void init_buffer() override final;
-    void destroy_buffer() override final;
   protected:
     void setup_buffer() override final;
   public:
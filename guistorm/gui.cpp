@@ -1,17 +1,23 @@
 #include "gui.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #ifndef GUISTORM_NO_TEXT
   #include <freetype-gl/texture-atlas.h>
+  #include "font_cache.h"
+  #if !defined(GUISTORM_SINGLETHREADED) && !defined(GUISTORM_NO_FREETYPE)
+    #include <thread>
+  #endif // !defined(GUISTORM_SINGLETHREADED) && !defined(GUISTORM_NO_FREETYPE)
 #endif // GUISTORM_NO_TEXT
 #include "blob_loader.h"
 #include "cast_if_required.h"
-#include "shader_load.h"
 #include "rounding.h"
 #ifdef GUISTORM_NO_TEXT
   #include "base.h"
 #else
   #include "input_text.h"
 #endif // GUISTORM_NO_TEXT
+#include "window.h"
 
 namespace guistorm {
 
@@ -53,49 +59,203 @@ void gui::destroy() {
 
 void gui::init_buffer() {
   /// Generate the buffers for this object
-  std::cout << "GUIStorm: Initialising " << elements.size() << " top level buffers..." << std::endl;
-  for(auto & element : elements) {
-    element->init_buffer();
-  }
+  std::cout << "GUIStorm: Initialising render buffers for " << elements.size() << " top level elements..." << std::endl;
+  render_batch.init_buffer();
 }
 void gui::destroy_buffer() {
   /// Clean up the buffers in preparation for exit or context switch
+  render_batch.destroy_buffer();
+  layer_batch.destroy_buffer();
+  if(layer.get_texture() != 0) {
+    layer.destroy(*render_backend);
+  }
   container::destroy_buffer();
 }
 
+void gui::set_backend(backend &new_backend) {
+  /// Send all graphics api calls to a different backend, such as backend_null for running headless
+  /// This must be called before init(), or between destroy() and init()
+  render_state.set_target(new_backend);
+}
+backend &gui::get_backend() {
+  /// Return the backend all graphics api calls are sent to
+  return render_state.get_target();
+}
+gui::statistics const &gui::get_stats() const {
+  /// Return the work done during the last completed frame, from the end of the render before it to the end of the last render
+  return stats_last_frame;
+}
+
+void gui::set_layered(bool new_layered) {
+  /// Choose whether to keep the gui drawn in a layer of its own, and each frame only redraw the parts that
+  /// changed into it, under a scissor, before compositing the layer over the scene as a single quad
+  /// While nothing changes this costs the gpu almost nothing; falls back to drawing directly without framebuffers
+  if(layered == new_layered) {
+    return;
+  }
+  layered = new_layered;
+  if(!layered && layer.get_texture() != 0) {
+    layer.destroy(*render_backend);
+  }
+  damage_all();
+}
+bool gui::is_layered() const {
+  /// Return whether the gui is drawn through a layer
+  return layered;
+}
+void gui::add_damage(coordtype const &corner0, coordtype const &corner1) {
+  /// Add a rectangle of the window to the region to redraw this frame, in window pixels, in any orientation
+  /// Elements do this themselves as they change; call it for anything drawn outside an element's bounds
+  coordtype const lower(std::min(corner0.x, corner1.x), std::min(corner0.y, corner1.y));
+  coordtype const upper(std::max(corner0.x, corner1.x), std::max(corner0.y, corner1.y));
+  if(!damaged) {
+    damage_corner0 = lower;
+    damage_corner1 = upper;
+    damaged = true;
+    return;
+  }
+  damage_corner0.x = std::min(damage_corner0.x, lower.x);
+  damage_corner0.y = std::min(damage_corner0.y, lower.y);
+  damage_corner1.x = std::max(damage_corner1.x, upper.x);
+  damage_corner1.y = std::max(damage_corner1.y, upper.y);
+}
+void gui::damage_all() {
+  /// Redraw the whole window next frame
+  add_damage(coordtype(0.0f, 0.0f), windowsize);
+}
+
+bool gui::setup_layer() {
+  /// Make sure the layer exists and covers the window, returning false if we have to draw directly instead
+  GLsizei const width  = static_cast<GLsizei>(std::ceil(windowsize.x));
+  GLsizei const height = static_cast<GLsizei>(std::ceil(windowsize.y));
+  if(width == layer.get_width() && height == layer.get_height()) {
+    return true;                                                                // already set up
+  }
+  if(!render_backend->has_framebuffers() || width <= 0 || height <= 0 || width > render_backend->get_max_texture_size() || height > render_backend->get_max_texture_size()) {
+    return false;
+  }
+  if(!layer.setup(*render_backend, width, height)) {
+    std::cout << "GUIStorm: ERROR: " << __PRETTY_FUNCTION__ << ": cannot draw into a texture for a " << width << "x" << height << " layer, drawing directly" << std::endl;
+    layered = false;
+    return false;
+  }
+  damage_all();                                                                 // the new layer is empty
+  return true;
+}
+void gui::render_layer(GLuint texture) {
+  /// Redraw the damaged part of the layer from this frame's batch, leaving the rest as it was
+  GLint const x0 = std::max(static_cast<GLint>(std::floor(damage_corner0.x)) - 1, 0); // a pixel's margin for lines and rounding
+  GLint const y0 = std::max(static_cast<GLint>(std::floor(damage_corner0.y)) - 1, 0);
+  GLint const x1 = std::min(static_cast<GLint>(std::ceil( damage_corner1.x)) + 1, layer.get_width());
+  GLint const y1 = std::min(static_cast<GLint>(std::ceil( damage_corner1.y)) + 1, layer.get_height());
+  if(x1 <= x0 || y1 <= y0) {
+    return;                                                                     // only changed outside the window
+  }
+  layer.begin(*render_backend);
+  render_backend->enable(GL_SCISSOR_TEST);
+  render_backend->scissor(x0, y0, x1 - x0, y1 - y0);
+  render_backend->clear_colour_buffer(0.0f, 0.0f, 0.0f, 0.0f);                  // the scissor limits this too
+  render_batch.render(texture);
+  render_backend->disable(GL_SCISSOR_TEST);
+  layer.end(*render_backend);
+  stats.pixels_redrawn += static_cast<size_t>(x1 - x0) * static_cast<size_t>(y1 - y0);
+}
+
 void gui::load_shader() {
   /// Load and initialise the gui shader
   if(shader != 0) {
     return;                                                                     // shader already initialised elsewhere
   }
-  std::cout << "GUIStorm: ";
-  shader = shader_load(std::string(R"(#version 120
-                                      #pragma optimize(on)
-                                      #pragma debug(off)
-
-                                      attribute vec4 coords;                    // we only input a vec3, so w defaults to 1.0
-                                      attribute vec2 texcoords;
-
-                                      varying vec2 texcoords_frag;
-
-                                      void main() {
-                                        texcoords_frag = texcoords;
-                                        gl_Position = coords;
-                                      }
+  // the vertex shader is assembled from the parts each build option needs
+  std::string vertex_source(R"(#version 120
+                               #pragma optimize(on)
+                               #pragma debug(off)
+
+                               uniform vec4 projection;                         // xy scale and zw offset from window pixels to normalised device coordinates
+
+                               attribute vec2 coords;
+                               attribute vec2 texcoords;
+                               attribute vec4 colour;                           // with transitions, the colour at the start of the transition
+
+                               varying vec2 texcoords_frag;
+                               varying vec4 colour_frag;
+                            )");
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    vertex_source += R"(
+                               uniform float time;                              // animation time in seconds, which all transitions are timed against
+
+                               attribute vec4 colour_target;                    // colour at the end of the transition
+                               attribute vec4 transition;                       // start time, rate (1 / duration or 0 for none), easing
+                       )";
+  #endif // GUISTORM_GPU_TRANSITIONS
+  #ifdef GUISTORM_INSTANCED_QUADS
+    vertex_source += R"(
+                               attribute vec2 corner;                           // corner of the unit square, per vertex
+                               attribute vec4 coords_basis;                     // per instance, the screen edges from the first corner to the second and fourth
+                               attribute vec4 texcoords_basis;                  // per instance, the same edges in the texture; both zero when drawing plain vertices
+                       )";
+  #endif // GUISTORM_INSTANCED_QUADS
+  vertex_source += R"(
+                               void main() {
+                       )";
+  #ifdef GUISTORM_INSTANCED_QUADS
+    vertex_source += R"(
+                                 vec2 position  = coords    + (corner.x * coords_basis.xy)    + (corner.y * coords_basis.zw);
+                                 texcoords_frag = texcoords + (corner.x * texcoords_basis.xy) + (corner.y * texcoords_basis.zw);
+                       )";
+  #else
+    vertex_source += R"(
+                                 vec2 position  = coords;
+                                 texcoords_frag = texcoords;
+                       )";
+  #endif // GUISTORM_INSTANCED_QUADS
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    vertex_source += R"(
+                                 float t = 1.0;
+                                 if(transition.y > 0.0) {
+                                   t = clamp((time - transition.x) * transition.y, 0.0, 1.0);
+                                 }
+                                 float factor;                                  // easing, matching easetype and colourset::get_progress
+                                 if(transition.z < 0.5) {
+                                   factor = t;                                  // linear
+                                 } else if(transition.z < 1.5) {
+                                   factor = t * t;                              // ease in
+                                 } else if(transition.z < 2.5) {
+                                   factor = t * (2.0 - t);                      // ease out
+                                 } else {
+                                   factor = t * t * (3.0 - (2.0 * t));          // ease in and out
+                                 }
+                                 colour_frag = mix(colour, colour_target, factor);
+                       )";
+  #else
+    vertex_source += R"(
+                                 colour_frag = colour;
+                       )";
+  #endif // GUISTORM_GPU_TRANSITIONS
+  vertex_source += R"(
+                                 gl_Position = vec4((position * projection.xy) + projection.zw, 0.0, 1.0);
+                               }
+                       )";
 
-                                   )"),
+  std::cout << "GUIStorm: ";
+  shader = render_backend->load_program(vertex_source,
                        std::string(R"(#version 120
                                       #pragma optimize(on)
                                       #pragma debug(off)
 
-                                      uniform vec4 colour;
                                       uniform sampler2D texture;
+                                      uniform float texture_colour;             // 1 when sampling the premultiplied colour of a cached window, 0 when sampling the font atlas's alpha
 
                                       varying vec2 texcoords_frag;
+                                      varying vec4 colour_frag;
 
                                       void main() {
-                                        float a = texture2D(texture, texcoords_frag).a;
-                                        gl_FragColor = vec4(colour.rgb, colour.a * a);
+                                        vec4 texel = texture2D(texture, texcoords_frag);
+                                        if(texture_colour > 0.5) {
+                                          gl_FragColor = colour_frag * vec4(texel.rgb / max(texel.a, 1.0 / 255.0), texel.a); // undo the premultiplication the cache was drawn with
+                                        } else {
+                                          gl_FragColor = vec4(colour_frag.rgb, colour_frag.a * texel.a);
+                                        }
                                       }
                                    )"));
   if(shader == GL_FALSE) {
@@ -103,9 +263,21 @@ void gui::load_shader() {
     exit(EXIT_FAILURE);
   }
   // cache attribute and uniform indices
-  attrib_coords    = glGetAttribLocation(shader, "coords");
-  attrib_texcoords = glGetAttribLocation(shader, "texcoords");
-  uniform_colour   = glGetUniformLocation(shader, "colour");
+  attrib_coords    = render_backend->get_attrib_location(shader, "coords");
+  attrib_texcoords = render_backend->get_attrib_location(shader, "texcoords");
+  attrib_colour    = render_backend->get_attrib_location(shader, "colour");
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    attrib_colour_target = render_backend->get_attrib_location(shader, "colour_target");
+    attrib_transition    = render_backend->get_attrib_location(shader, "transition");
+    uniform_time         = render_backend->get_uniform_location(shader, "time");
+  #endif // GUISTORM_GPU_TRANSITIONS
+  #ifdef GUISTORM_INSTANCED_QUADS
+    attrib_corner          = render_backend->get_attrib_location(shader, "corner");
+    attrib_coords_basis    = render_backend->get_attrib_location(shader, "coords_basis");
+    attrib_texcoords_basis = render_backend->get_attrib_location(shader, "texcoords_basis");
+  #endif // GUISTORM_INSTANCED_QUADS
+  uniform_projection     = render_backend->get_uniform_location(shader, "projection");
+  uniform_texture_colour = render_backend->get_uniform_location(shader, "texture_colour");
 }
 
 void gui::destroy_shader() {
@@ -113,7 +285,7 @@ void gui::destroy_shader() {
   if(shader == 0) {
     return;
   }
-  glDeleteProgram(shader);
+  render_backend->delete_program(shader);
   shader = 0;
 }
 
@@ -121,82 +293,207 @@ void gui::destroy_shader() {
 void gui::load_fonts() {
   /// Initialise the font atlas and any font associated objects
   /// Note: TextureAtlas depth == 1 uses format GL_RED by default which is not available on older hardware, so we need to upload manually in those cases
-  vec2<size_t> newsize(256, 256);
-  bool atlas_complete;
-  do {
-    atlas_complete = true;
-    delete font_atlas;
-    font_atlas = new freetypeglxx::TextureAtlas(newsize.x, newsize.y, 1);
-    std::cout << "GUIStorm: Loading " << fonts.size() << " fonts to " << font_atlas->width() << "x" << font_atlas->height() << " atlas..." << std::endl;
-    for(auto const &thisfont : fonts) {
-      atlas_complete = thisfont->load(font_atlas);
-      if(!atlas_complete) {                                                     // attempt to scale the texture until we reach opengl texture max size
-        std::cout << "GUIStorm: Texture atlas full (no room for " << thisfont->name << " size " << thisfont->font_size << "), growing atlas..." << std::endl;
-        thisfont->unload();
-        newsize *= 2;
-        GLint maxtexture;
-        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxtexture);
-        if(newsize.x > static_cast<unsigned int>(maxtexture)) {
-          std::cout << "GUIStorm: ERROR: would need to scale atlas past max texture size of " << maxtexture << "x" << maxtexture << ", abandoning!" << std::endl;
-          return;
-        }
-        break;
+  /// With a font_cache_path set, an atlas built for exactly these fonts on an earlier run is loaded from there instead
+  if(!font_cache_path.empty() && font_cache::load(font_cache_path, *this)) {
+    upload_fonts();
+    return;
+  }
+  rasterise_fonts();                                                            // the slow part, done once however many times the atlas has to grow
+  delete font_atlas;
+  font_atlas = new freetypeglxx::TextureAtlas(256, 256, 1);
+  std::cout << "GUIStorm: Loading " << fonts.size() << " fonts to " << font_atlas->width() << "x" << font_atlas->height() << " atlas..." << std::endl;
+  for(auto const &thisfont : fonts) {
+    thisfont->unload();
+  }
+  for(auto const &thisfont : fonts) {
+    while(!thisfont->pack(font_atlas)) {                                        // packing picks up where it left off, so each glyph is only placed once
+      std::cout << "GUIStorm: Texture atlas full (no room for " << thisfont->name << " size " << thisfont->font_size << "), growing atlas..." << std::endl;
+      if(!grow_font_atlas()) {
+        #ifndef GUISTORM_NO_FREETYPE
+          for(auto const &thisfont : fonts) {
+            thisfont->rasterise_end();
+          }
+        #endif // GUISTORM_NO_FREETYPE
+        return;
       }
     }
-  } while(!atlas_complete);
+  }
+  #ifndef GUISTORM_NO_FREETYPE
+    for(auto const &thisfont : fonts) {
+      thisfont->rasterise_end();                                                // everything's packed, so the bitmaps are in the atlas now
+    }
+  #endif // GUISTORM_NO_FREETYPE
+  if(!font_cache_path.empty()) {
+    font_cache::save(font_cache_path, *this);                                   // so the next run can skip all that
+  }
   upload_fonts();                                                               // upload manually since we've reimplemented loadGlyphs' uploader and so not using font_atlas->Upload()
 }
 
+bool gui::grow_font_atlas() {
+  /// Double the size of the font atlas, keeping every glyph already packed exactly where it is
+  /// The old bitmap and the packer's skyline are carried over, so packing carries on into the new space
+  /// Texcoords are rescaled to match; nothing is uploaded, as that happens once the atlas is complete
+  vec2<size_t> const oldsize(font_atlas->width(),     font_atlas->height());
+  vec2<size_t> const newsize(font_atlas->width() * 2, font_atlas->height() * 2);
+  GLint const maxtexture = render_backend->get_max_texture_size();
+  if(newsize.x > static_cast<unsigned int>(maxtexture)) {                       // attempt to scale the texture until we reach opengl texture max size
+    std::cout << "GUIStorm: ERROR: would need to scale atlas past max texture size of " << maxtexture << "x" << maxtexture << ", abandoning!" << std::endl;
+    return false;
+  }
+  size_t const depth = font_atlas->depth();
+  freetypeglxx::TextureAtlas *newatlas = new freetypeglxx::TextureAtlas(newsize.x, newsize.y, depth);
+  texture_atlas_t const *old_self = static_cast<texture_atlas_t const*>(font_atlas->RawGet());
+  texture_atlas_t       *new_self = static_cast<texture_atlas_t*>(newatlas->RawGet());
+  for(size_t y = 0; y != oldsize.y; ++y) {                                      // rows keep their place, just spaced further apart
+    std::copy_n(old_self->data + y * oldsize.x * depth, oldsize.x * depth, new_self->data + y * newsize.x * depth);
+  }
+  vector_clear(new_self->nodes);                                                // replace the new atlas's empty skyline with the old one...
+  for(size_t i = 0; i != vector_size(old_self->nodes); ++i) {
+    vector_push_back(new_self->nodes, vector_get(old_self->nodes, i));
+  }
+  int const node[3] = {static_cast<int>(oldsize.x) - 1,                         // ...plus the space to its right, laid out as freetype-gl's ivec3 x, y, width
+                       1,
+                       static_cast<int>(newsize.x - oldsize.x)};
+  vector_push_back(new_self->nodes, node);
+  new_self->used = old_self->used;
+  delete font_atlas;
+  font_atlas = newatlas;
+  coordtype const texcoord_scale(static_cast<GLfloat>(oldsize.x) / static_cast<GLfloat>(newsize.x),
+                                 static_cast<GLfloat>(oldsize.y) / static_cast<GLfloat>(newsize.y));
+  for(auto const &thisfont : fonts) {
+    thisfont->scale_texcoords(texcoord_scale);
+  }
+  ++font_atlas_generation;
+  #ifdef DEBUG_GUISTORM
+    std::cout << "GUIStorm: Grew font atlas to " << newsize.x << "x" << newsize.y << std::endl;
+  #endif // DEBUG_GUISTORM
+  return true;
+}
+
+void gui::rasterise_fonts() {
+  /// Rasterise every font's glyphs ready to pack into the atlas, spread across all available cores
+  /// Each font's glyphs are split into ranges, and each thread opens freetype for itself to work through them
+  #ifndef GUISTORM_NO_FREETYPE
+    struct task {
+      font *thisfont;
+      size_t first;
+      size_t last;
+    };
+    std::vector<task> tasks;
+    size_t constexpr glyphs_per_task = 128;                                     // big enough to be worth opening a face for, small enough to balance large fonts
+    for(auto const &thisfont : fonts) {
+      if(thisfont->baked) {
+        continue;                                                               // nothing to rasterise
+      }
+      thisfont->rasterise_begin();
+      size_t const glyph_count = thisfont->charcodes.size();
+      for(size_t first = 0; first < glyph_count || first == 0; first += glyphs_per_task) { // always at least one, so the font's metrics are read
+        tasks.emplace_back(task{thisfont, first, std::min(first + glyphs_per_task, glyph_count)});
+      }
+    }
+    #ifdef GUISTORM_SINGLETHREADED
+      for(auto const &thistask : tasks) {
+        thistask.thisfont->rasterise(thistask.first, thistask.last);
+      }
+    #else
+      std::atomic<size_t> next_task{0};
+      auto const worker = [&tasks, &next_task]{
+        for(size_t i = next_task++; i < tasks.size(); i = next_task++) {
+          tasks[i].thisfont->rasterise(tasks[i].first, tasks[i].last);
+        }
+      };
+      size_t const thread_count = std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)), tasks.size());
+      std::vector<std::thread> threads;
+      for(size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+      }
+      worker();                                                                 // this thread does its share too
+      for(auto &thisthread : threads) {
+        thisthread.join();
+      }
+    #endif // GUISTORM_SINGLETHREADED
+    #ifdef DEBUG_GUISTORM
+      std::cout << "GUIStorm: Rasterised " << fonts.size() << " fonts in " << tasks.size() << " tasks" << std::endl;
+    #endif // DEBUG_GUISTORM
+  #endif // GUISTORM_NO_FREETYPE
+}
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstack-usage="
 void gui::upload_fonts() {
   /// Manually upload the texture as GL_ALPHA instead of not-always-supported GL_RED which is default in freetype-gl
+  render_state.invalidate();                                                    // this may run between frames, after the application has bound its own texture
   texture_atlas_t *atlas_self = static_cast<texture_atlas_t*>(font_atlas->RawGet());
   if(!font_atlas->id()) {                                                       // if no texture has been generated, then generate one ourselves
-    glGenTextures(1, &atlas_self->id);
+    atlas_self->id = render_backend->gen_texture();
   }
-  glBindTexture(GL_TEXTURE_2D, font_atlas->id());
+  render_backend->bind_texture(GL_TEXTURE_2D, font_atlas->id());
   if(font_atlas_filtering) {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   } else {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  }
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexImage2D(GL_TEXTURE_2D,
-               0,
-               GL_ALPHA,
-               cast_if_required<GLsizei>(font_atlas->width()),
-               cast_if_required<GLsizei>(font_atlas->height()),
-               0,
-               GL_ALPHA,
-               GL_UNSIGNED_BYTE,
-               atlas_self->data);
+    render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  }
+  render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  render_backend->tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  render_backend->tex_image_2d(GL_TEXTURE_2D,
+                               GL_ALPHA,
+                               cast_if_required<GLsizei>(font_atlas->width()),
+                               cast_if_required<GLsizei>(font_atlas->height()),
+                               GL_ALPHA,
+                               GL_UNSIGNED_BYTE,
+                               atlas_self->data);
 
   // set the 1,0 to 1,1 texels of the font atlas texture to a 0.0-1.0 alpha gradient to use the shader for solid objects without texture switching
-  constexpr GLsizei strip_height = 2;
-  GLfloat data[strip_height][font_atlas->width()];
-  for(GLsizei y = 0; y != strip_height; ++y) {
+  GLfloat data[font_atlas_strip_height][font_atlas->width()];
+  for(GLsizei y = 0; y != font_atlas_strip_height; ++y) {
     for(GLsizei x = 0; x != cast_if_required<GLsizei>(font_atlas->width()); ++x) {
       data[y][x] = static_cast<GLfloat>(x) / static_cast<GLfloat>(font_atlas->width() - 1); // produce a gradient from 0 to 1 in unsigned byte form
     }
   }
-  glTexSubImage2D(GL_TEXTURE_2D,
-                  0,
-                  0,
-                  cast_if_required<GLsizei>(font_atlas->height()) - strip_height,
-                  cast_if_required<GLsizei>(font_atlas->width()),
-                  strip_height,
-                  GL_ALPHA,
-                  GL_FLOAT,
-                  data);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  render_backend->tex_sub_image_2d(GL_TEXTURE_2D,
+                                   0,
+                                   cast_if_required<GLsizei>(font_atlas->height()) - font_atlas_strip_height,
+                                   cast_if_required<GLsizei>(font_atlas->width()),
+                                   font_atlas_strip_height,
+                                   GL_ALPHA,
+                                   GL_FLOAT,
+                                   data);
+  render_backend->bind_texture(GL_TEXTURE_2D, 0);
   std::cout << "GUIStorm: Font atlas uploaded, " << (font_atlas->width() * font_atlas->height()) / 1024 << "KB, id=" << font_atlas->id() << std::endl;
 }
 #pragma GCC diagnostic pop
 
+void gui::upload_font_rows(GLint first_row, GLsizei row_count) {
+  /// Upload a band of rows of the font atlas to the existing texture, after glyphs have been added to it
+  /// Whole rows are sent as they're contiguous in the atlas bitmap, so no unpack row length is needed
+  if(!font_atlas->id()) {
+    upload_fonts();                                                             // no texture yet to update
+    return;
+  }
+  render_state.invalidate();                                                    // this may run between frames, after the application has bound its own texture
+  GLint const last_row = std::min(first_row + row_count,
+                                  cast_if_required<GLint>(font_atlas->height()) - font_atlas_strip_height); // leave the gradient strip alone
+  if(last_row <= first_row) {
+    return;
+  }
+  texture_atlas_t const *atlas_self = static_cast<texture_atlas_t const*>(font_atlas->RawGet());
+  render_backend->bind_texture(GL_TEXTURE_2D, font_atlas->id());
+  render_backend->tex_sub_image_2d(GL_TEXTURE_2D,
+                                   0,
+                                   first_row,
+                                   cast_if_required<GLsizei>(font_atlas->width()),
+                                   last_row - first_row,
+                                   GL_ALPHA,
+                                   GL_UNSIGNED_BYTE,
+                                   atlas_self->data + static_cast<size_t>(first_row) * font_atlas->width() * font_atlas->depth());
+  render_backend->bind_texture(GL_TEXTURE_2D, 0);
+  #ifdef DEBUG_GUISTORM
+    std::cout << "GUIStorm: Font atlas rows " << first_row << " to " << last_row << " uploaded" << std::endl;
+  #endif // DEBUG_GUISTORM
+}
+
 void gui::destroy_fonts() {
   /// Clean up the font atlas in preparation for exit or context switch
   for(auto f : fonts) {
@@ -210,7 +507,126 @@ void gui::destroy_fonts() {
 void gui::refresh() {
   /// Re-create the buffers of all elements in this gui
   container::refresh();
-  picked_element = get_picked(cursor_position);                                 // traverse the tree to update the currently picked element
+  update_cursor_pick();
+}
+
+float gui::update_frame_time() {
+  /// Return the time in seconds since the last frame, limited to frame_time_max
+  auto const frame_time_now(std::chrono::steady_clock::now());
+  float delta_time = 0.0f;
+  if(frame_time_started) {
+    delta_time = std::min(std::chrono::duration<float>(frame_time_now - frame_time_last).count(), frame_time_max);
+  }
+  frame_time_last = frame_time_now;
+  frame_time_started = true;
+  return delta_time;
+}
+float gui::get_time() const {
+  /// Return the current animation time in seconds, which colour transitions are timed against
+  return time;
+}
+void gui::advance_colours() {
+  /// Advance the colour transitions of every element that's still transitioning, and drop those that are finished
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(animating_elements_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  for(size_t i = 0; i != animating_elements.size();) {
+    base *element = animating_elements[i];
+    if(element->advance_colours(time)) {
+      ++i;
+    } else {
+      animating_elements[i] = animating_elements.back();                        // order doesn't matter, so swap and pop
+      animating_elements.pop_back();
+    }
+  }
+}
+
+void gui::update_dirty() {
+  /// Carry out all deferred rebuilds since the last frame, each dirty element exactly once
+  if(layout_dirty) {
+    layout_dirty = false;
+    update_layout();                                                            // this may dirty further elements, which are picked up below
+  }
+  #ifndef GUISTORM_SINGLETHREADED
+    std::unique_lock lock(dirty_elements_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  for(size_t i = 0; i != dirty_elements.size(); ++i) {                          // the list may grow while we iterate, so don't use iterators
+    base *element = dirty_elements[i];
+    #ifndef GUISTORM_SINGLETHREADED
+      lock.unlock();                                                            // rebuilding may need to invalidate other elements
+    #endif // GUISTORM_SINGLETHREADED
+    element->update_dirty();
+    #ifndef GUISTORM_SINGLETHREADED
+      lock.lock();
+    #endif // GUISTORM_SINGLETHREADED
+  }
+  dirty_elements.clear();
+}
+
+void gui::advance() {
+  /// Advance the gui by one frame without drawing it: rebuild anything invalidated, step colour transitions,
+  /// let every element react to the cursor and mouse, and count mouse frames
+  /// render does this itself unless it's been called since the last render, so a host can keep the gui
+  /// responsive every frame while only drawing the frames needs_redraw says would look different
+  update_dirty();                                                               // rebuild anything invalidated since the last frame
+  time += update_frame_time();
+  advance_colours();                                                            // only touches elements still transitioning
+  for(auto &element : elements) {
+    element->update_subtree();                                                  // react to the cursor before drawing, so the result is seen this frame
+  }
+
+  mouse_released = false;
+  if(mouse_pressed) {
+    ++mouse_pressed_frames;                                                     // keep track of how long the mouse has been pressed
+  } else {
+    if(mouse_pressed_frames != 0) {
+      mouse_released = true;                                                    // create a flag for one frame when the mouse is released
+    }
+    mouse_pressed_frames = 0;
+  }
+  advanced = true;
+}
+bool gui::needs_redraw() {
+  /// Return whether the next frame would look any different from the last one drawn, or has input to act on
+  /// While this is false the host can skip rendering and wait for input instead, such as with glfwWaitEvents
+  /// Colour transitions need drawing every frame until they end, so there's no later deadline to wake for
+  if(redraw_requested || damaged || layout_dirty || mouse_pressed || mouse_released) {
+    return true;                                                                // held mouse buttons press their elements every frame
+  }
+  {
+    #ifndef GUISTORM_SINGLETHREADED
+      std::lock_guard lock(dirty_elements_mutex);
+    #endif // GUISTORM_SINGLETHREADED
+    if(!dirty_elements.empty()) {
+      return true;
+    }
+  }
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(redraw_until_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  return time < redraw_until;                                                   // true until the frame drawn after the last transition ends
+}
+void gui::request_redraw() {
+  /// Note that something has changed which the next frame has to show
+  /// Elements do this themselves as they change; call it after changing anything else the gui can't see
+  redraw_requested = true;
+}
+void gui::request_redraw_until(float until) {
+  /// Keep needs_redraw true every frame until the given gui time, while something is animating
+  redraw_requested = true;
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(redraw_until_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  redraw_until = std::max(redraw_until, until);
+}
+void gui::restyle() {
+  /// Show changes to a shared palette everywhere: in cached windows, in the layer and on the next frame
+  /// Call this after assigning new colours to a theme made with std::make_shared
+  for(auto &element : elements) {
+    element->restyle();
+  }
+  damage_all();
+  request_redraw();
 }
 
 void gui::render() {
@@ -219,45 +635,76 @@ void gui::render() {
     std::cout << "WARNING: shader had not been pre-loaded before gui::render called" << std::endl;
     load_shader();
   }
-  glDisable(GL_DEPTH_TEST);
-  glUseProgram(shader);
-  glEnableVertexAttribArray(attrib_coords);
-  glEnableVertexAttribArray(attrib_texcoords);
-  #ifndef GUISTORM_NO_TEXT
-    glBindTexture(GL_TEXTURE_2D, font_atlas->id());
+  render_state.invalidate();                                                    // the application may have changed anything since our last frame
+  redraw_requested = false;                                                     // cleared first, so anything changing while we draw is caught next frame
+  if(!advanced) {
+    advance();
+  }
+  advanced = false;
+  update_dirty();                                                               // rebuild anything invalidated as elements reacted to input
+  render_batch.clear();
+  render_batch.set_clip(coordtype(0.0f, 0.0f), windowsize);                     // nothing outside the window can be seen
+  container::render();                                                          // collect the geometry of every visible element in painter's order
+
+  render_backend->disable(GL_DEPTH_TEST);
+  render_backend->use_program(shader);
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    render_backend->uniform1f(uniform_time, time);                              // all colour transitions are evaluated against this
+  #endif // GUISTORM_GPU_TRANSITIONS
+  #ifdef GUISTORM_NO_TEXT
+    GLuint const texture = 0;
+  #else
+    GLuint const texture = font_atlas->id();
   #endif // GUISTORM_NO_TEXT
+  render_backend->bind_texture(GL_TEXTURE_2D, texture);
 
-  container::render();
+  for(auto const &it : render_cache_pending) {                                  // innermost first, so windows cached within cached windows are ready in time
+    it->render_cache(texture);
+  }
+  render_cache_pending.clear();
+
+  render_backend->uniform4f(uniform_projection, 2.0f / windowsize.x, 2.0f / windowsize.y, -1.0f, -1.0f); // the window size reaches the gpu here, and only cached windows use another
+  if(layered && setup_layer()) {
+    if(damaged) {
+      render_layer(texture);                                                    // bring the changed parts of the layer up to date
+    }
+    layer_batch.clear();
+    layer_batch.add_texture(coordtype(0.0f, 0.0f),
+                            coordtype(static_cast<coordcomponent>(layer.get_width()), static_cast<coordcomponent>(layer.get_height())),
+                            layer.get_texture(),
+                            paint(colourtype(1.0f, 1.0f, 1.0f, 1.0f)));
+    layer_batch.render(texture);                                                // and composite it over the scene
+  } else {
+    render_batch.render(texture);                                               // upload and draw everything collected
+  }
+  damaged = false;
 
-  glDisableVertexAttribArray(attrib_coords);
-  glDisableVertexAttribArray(attrib_texcoords);
   #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glUseProgram(0);
+    render_backend->bind_buffer(GL_ARRAY_BUFFER,         0);
+    render_backend->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    render_backend->use_program(0);
     #ifndef GUISTORM_NO_TEXT
-      glBindTexture(GL_TEXTURE_2D, 0);
+      render_backend->bind_texture(GL_TEXTURE_2D, 0);
     #endif // GUISTORM_NO_TEXT
   #endif // GUISTORM_UNBIND
-  glEnable(GL_DEPTH_TEST);
+  render_backend->enable(GL_DEPTH_TEST);
 
-  mouse_released = false;
-  if(mouse_pressed) {
-    ++mouse_pressed_frames;                                                     // keep track of how long the mouse has been pressed
-  } else {
-    if(mouse_pressed_frames != 0) {
-      mouse_released = true;                                                    // create a flag for one frame when the mouse is released
-    }
-    mouse_pressed_frames = 0;
-  }
+  stats.state_changes_skipped += render_state.take_skipped();
+  render_state.invalidate();                                                    // and again as we hand the context back, so uploads between frames don't trust stale binds
+  stats_last_frame = stats;                                                     // start counting the next frame
+  stats = statistics();
 }
 
 void gui::add_to_gui(base *element) {
   /// Add the element to this gui
   element->parent_gui = this;
+  #ifdef GUISTORM_PICK_GRID
+    pick_index.invalidate_all();                                                // ranks have changed
+  #endif // GUISTORM_PICK_GRID
 }
 
 #ifndef GUISTORM_NO_TEXT
+#ifndef GUISTORM_NO_FREETYPE
 void gui::add_font(std::string const &name,
                    std::string_view buffer,
                    float font_size,
@@ -273,6 +720,15 @@ void gui::add_font(std::string const &name,
     std::cout << "GUIStorm: added font " << name << " size " << font_size << ", " << fonts.size() << " total" << std::endl;
   #endif // DEBUG_GUISTORM
 }
+#endif // GUISTORM_NO_FREETYPE
+void gui::add_font(baked_font const &baked) {
+  /// Font factory for a font baked ahead of time with the bake_font tool, which loads without rasterising anything
+  /// The baked data must outlive the gui - it's meant to be the constant data from the tool's header
+  fonts.emplace_back(new font(this, baked));
+  #ifdef DEBUG_GUISTORM
+    std::cout << "GUIStorm: added baked font " << baked.name << " size " << baked.font_size << ", " << fonts.size() << " total" << std::endl;
+  #endif // DEBUG_GUISTORM
+}
 void gui::add_font(font *thisfont) {
   /// Take ownership of an existing font
   /// NOTE: guistorm will now free this font, do not try to delete it manually
@@ -383,7 +839,7 @@ font *gui::get_font_by_size_or_bigger(float size) {
 #endif // GUISTORM_NO_TEXT
 
 void gui::set_windowsize(coordtype const &new_windowsize) {
-  /// Cache the window size and refresh buffers if it's changed
+  /// Cache the window size and reposition window-relative elements if it's changed
   #ifdef DEBUG_GUISTORM
     std::cout << "GUIStorm: Window resized to " << new_windowsize << std::endl;
   #endif // DEBUG_GUISTORM
@@ -391,15 +847,11 @@ void gui::set_windowsize(coordtype const &new_windowsize) {
     return;
   }
   windowsize = new_windowsize;
-  update_layout();                                                              // reposition any window-relative GUI elements
-  // update all buffers
-  if(glfwGetCurrentContext() != NULL) {                                         // make sure we're in a valid opengl context before we try to refresh
-    refresh();
-  } else {
-    #ifdef DEBUG_GUISTORM
-      std::cout << "GUIStorm: Window resize called outside opengl context" << std::endl;
-    #endif
-  }
+  layout_dirty = true;                                                          // reposition any window-relative GUI elements once before the next frame
+  #ifdef GUISTORM_PICK_GRID
+    pick_index.invalidate_all();                                                // the grid covers the window
+  #endif // GUISTORM_PICK_GRID
+  // geometry is kept in window pixels and projected in the shader, so nothing else needs rebuilding
 }
 
 GLfloat gui::get_dpi() const {
@@ -422,24 +874,34 @@ void gui::set_cursor_position(coordtype const &new_cursor_position) {
   /// Update the cursor position
   cursor_position = new_cursor_position;
   if(cursor) {
-    cursor->set_position_nodpiscale(cursor_position);                           // don't call the dpi scaler function
-    cursor->refresh_position_only();
+    cursor->set_position_nodpiscale(cursor_position);                           // don't call the dpi scaler function - the shape itself is unchanged
   }
   update_cursor_pick();
 }
 
 void gui::update_cursor_pick() {
   /// Update what the cursor is picking, for instance if windows have changed under the cursor without it having moved
-  picked_element = get_picked(cursor_position);                                 // traverse the tree to update the currently picked element
+  ++stats.picks;
+  base *const picked_element_old = picked_element;
+  #ifdef GUISTORM_PICK_GRID
+    picked_element = pick_index.get_picked(cursor_position);                    // look up the cell under the cursor
+  #else
+    picked_element = get_picked(cursor_position);                               // traverse the tree to update the currently picked element
+  #endif // GUISTORM_PICK_GRID
+  if(picked_element != picked_element_old) {
+    request_redraw();                                                           // something new is hovered over, or nothing is
+  }
 }
 
 void gui::set_mouse_pressed() {
   /// Tell the gui the mouse has been pressed
   mouse_pressed = true;
+  request_redraw();
 }
 void gui::set_mouse_released() {
   /// Tell the gui the mouse is being released
   mouse_pressed = false;
+  request_redraw();
   #ifndef GUISTORM_NO_TEXT
     if(!picked_element) {
       deselect_input_field();
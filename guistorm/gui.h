@@ -1,11 +1,22 @@
 #pragma once
 
+#include <vector>
+#include <atomic>
+#include <chrono>
+#ifndef GUISTORM_SINGLETHREADED
+  #include <mutex>
+#endif // GUISTORM_SINGLETHREADED
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #ifndef GUISTORM_NO_TEXT
   #include <freetype-gl++/texture-atlas.hpp>
 #endif // GUISTORM_NO_TEXT
 #include <guistorm/types.h>
+#include <guistorm/backend_gl.h>
+#include <guistorm/backend_cache.h>
+#include <guistorm/batch.h>
+#include <guistorm/render_target.h>
+#include <guistorm/pick_grid.h>
 #include <guistorm/container.h>
 #include <guistorm/font.h>
 
@@ -13,31 +24,125 @@ namespace guistorm {
 
 class lineshape;
 class input_text;
+class window;
 
 class gui final : public container {
   friend class base;
+  friend class batch;
   friend class input_text;
   friend class line;
   friend class lineshape;
   friend class progressbar;
   friend class graph_line;
   friend class graph_ringbuffer_line;
+  friend class container;
+  friend class window;
+  #ifndef GUISTORM_NO_TEXT
+    friend class font;
+    friend class font_cache;
+  #endif // GUISTORM_NO_TEXT
+  #ifdef GUISTORM_PICK_GRID
+    friend class pick_grid;
+  #endif // GUISTORM_PICK_GRID
 protected:
   static GLuint shader;                                                         // the shader for rendering all gui elements
   #ifndef GUISTORM_NO_TEXT
     freetypeglxx::TextureAtlas *font_atlas = nullptr;                           // texture atlas containing all font glyphs we use
+    static GLsizei constexpr font_atlas_strip_height = 2;                       // rows at the bottom of the atlas texture holding the gradient for solid shapes
+    unsigned int font_atlas_generation = 0;                                     // counts the times the atlas has grown, rescaling every glyph's texcoords
   #endif // GUISTORM_NO_TEXT
 public:
   bool font_atlas_filtering = true;                                             // whether to filter the font atlas linearly or use nearest neighbour - for subpixel offsets
   #ifndef GUISTORM_NO_TEXT
     std::vector<font*> fonts;                                                   // the list of fonts we contain
     font *font_default = nullptr;                                               // which font to recommend as default to child objects
+    std::string font_cache_path;                                                // file to keep the built font atlas in between runs, to skip freetype at startup - empty to always build it
   #endif // GUISTORM_NO_TEXT
 protected:
-  // per-vertex attribute indices
-  GLuint attrib_coords    = 0;
-  GLuint attrib_texcoords = 0;
-  GLuint uniform_colour   = 0;
+  backend_gl backend_default;                                                   // the backend used unless we're given another
+  backend_cache render_state{backend_default};                                  // drops calls that wouldn't change anything, before passing the rest on to the chosen backend
+  backend *render_backend = &render_state;                                      // where every call to the graphics api goes
+
+  // per-vertex attribute and uniform indices
+  GLuint attrib_coords      = 0;
+  GLuint attrib_texcoords   = 0;
+  GLuint attrib_colour      = 0;
+  #ifdef GUISTORM_GPU_TRANSITIONS
+    GLuint attrib_colour_target = 0;
+    GLuint attrib_transition    = 0;
+    GLuint uniform_time         = 0;
+  #endif // GUISTORM_GPU_TRANSITIONS
+  #ifdef GUISTORM_INSTANCED_QUADS
+    GLuint attrib_corner          = 0;
+    GLuint attrib_coords_basis    = 0;
+    GLuint attrib_texcoords_basis = 0;
+  #endif // GUISTORM_INSTANCED_QUADS
+  GLuint uniform_projection = 0;
+  GLuint uniform_texture_colour = 0;
+
+  batch render_batch{*this};                                                    // streaming renderer collecting all element geometry each frame
+  batch *current_batch = &render_batch;                                         // where elements submit their geometry - the render batch, or that of a cached window being redrawn
+  std::vector<window*> render_cache_pending;                                    // cached windows whose subtrees were collected this frame, to draw into their textures before the main batch
+
+  // damage tracking
+  bool damaged = false;                                                         // whether anything has changed since the last frame
+  coordtype damage_corner0;                                                     // lower left of the union of everything that changed since the last frame, in window pixels
+  coordtype damage_corner1;                                                     // upper right
+  bool layered = false;                                                         // whether to keep the gui drawn in a layer, redrawing only what changed, and composite that each frame
+  render_target layer;                                                          // the gui as it was last drawn, covering the window
+  batch layer_batch{*this};                                                     // the single quad compositing the layer
+
+  // idle frame skipping
+  bool advanced = false;                                                        // whether advance has run since the last render
+  std::atomic_bool redraw_requested{true};                                      // whether anything has changed that the next frame would show
+  float redraw_until = 0.0f;                                                    // gui time to keep drawing every frame until, while colours are changing
+  #ifndef GUISTORM_SINGLETHREADED
+    std::mutex redraw_until_mutex;                                              // protects redraw_until
+  #endif // GUISTORM_SINGLETHREADED
+
+  // deferred invalidation
+  std::vector<base*> dirty_elements;                                            // elements waiting to be rebuilt at the start of the next frame
+  #ifndef GUISTORM_SINGLETHREADED
+    std::mutex dirty_elements_mutex;                                            // protects the dirty list and each element's dirty bits
+  #endif // GUISTORM_SINGLETHREADED
+  bool layout_dirty = false;                                                    // whether the whole tree needs its layout rules re-applying, e.g. after a resize
+
+  // colour transitions
+  std::vector<base*> animating_elements;                                        // elements whose colours are still transitioning, the only ones advanced each frame
+  #ifndef GUISTORM_SINGLETHREADED
+    std::mutex animating_elements_mutex;                                        // protects the animating list and each element's animating flag
+  #endif // GUISTORM_SINGLETHREADED
+  std::chrono::steady_clock::time_point frame_time_last;                        // when the last frame was rendered, to measure the time between frames
+  bool frame_time_started = false;                                              // whether frame_time_last has been set yet
+  float time = 0.0f;                                                            // seconds of animation time since the gui was created, advanced by each frame's limited delta
+public:
+  float frame_time_max = 0.1f;                                                  // longest time step to advance transitions by, in seconds, so stalls don't skip animations entirely
+protected:
+
+  #ifdef GUISTORM_PICK_GRID
+    pick_grid pick_index{*this};                                                // spatial index answering what's under the cursor
+  #endif // GUISTORM_PICK_GRID
+
+public:
+  struct statistics {
+    /// Counts of the work done over one frame, for exporting to telemetry and checking against budgets
+    unsigned int draw_calls         = 0;                                        // draw calls issued
+    unsigned int buffer_uploads     = 0;                                        // vertex and index buffer uploads
+    size_t bytes_uploaded           = 0;                                        // bytes of vertex and index data uploaded
+    unsigned int elements_rebuilt   = 0;                                        // elements whose setup_buffer ran
+    unsigned int labels_setup       = 0;                                        // elements whose setup_label ran
+    unsigned int labels_arranged    = 0;                                        // elements whose arrange_label ran
+    unsigned int glyph_quads        = 0;                                        // glyph quads generated by setup_label
+    unsigned int picks              = 0;                                        // cursor picking queries
+    unsigned int pick_nodes_visited = 0;                                        // elements (or grid entries) tested by those queries
+    unsigned int layout_rules_run   = 0;                                        // layout rules executed
+    unsigned int state_changes_skipped = 0;                                     // binds, enables, attribute and uniform changes dropped as redundant by the state cache
+    size_t pixels_redrawn           = 0;                                        // area of the layer redrawn, when layered
+    unsigned int elements_culled    = 0;                                        // elements skipped, with anything inside them, for lying entirely outside the visible area
+  };
+protected:
+  statistics stats;                                                             // totals for the frame in progress, including work done between renders
+  statistics stats_last_frame;                                                  // totals for the last completed frame
 
 public:
   static GLfloat constexpr dpi_default = 72.0;                                  // standard pixels per inch
@@ -76,24 +181,54 @@ public:
   void destroy_shader();
   #ifndef GUISTORM_NO_TEXT
     void load_fonts();
+    bool grow_font_atlas();
+    void rasterise_fonts();
     void upload_fonts();
+    void upload_font_rows(GLint first_row, GLsizei row_count);
     void destroy_fonts();
   #endif // GUISTORM_NO_TEXT
   void refresh() override final;
+  void update_dirty();
+private:
+  float update_frame_time();
+public:
+  float get_time() const __attribute__((__pure__));
+  void advance_colours();
+
+  void set_backend(backend &new_backend);
+  backend &get_backend() __attribute__((__pure__));
+  statistics const &get_stats() const __attribute__((__const__));
+
+  void set_layered(bool new_layered);
+  bool is_layered() const __attribute__((__pure__));
+  void add_damage(coordtype const &corner0, coordtype const &corner1);
+  void damage_all();
+private:
+  bool setup_layer();
+  void render_layer(GLuint texture);
+public:
 
+  void advance();
+  bool needs_redraw();
+  void request_redraw();
+  void request_redraw_until(float until);
+  void restyle();
   void render() override final;
 
   void add_to_gui(base *element) override final;
   #ifndef GUISTORM_NO_TEXT
-    void add_font(std::string const &name,
-                  std::string_view buffer,
-                  float font_size,
-                  #ifdef GUISTORM_NO_UTF
-                    std::string const &glyphs_to_load = ""
-                  #else
-                    std::u32string const &glyphs_to_load = U""
-                  #endif // GUISTORM_NO_UTF
-                  );
+    #ifndef GUISTORM_NO_FREETYPE
+      void add_font(std::string const &name,
+                    std::string_view buffer,
+                    float font_size,
+                    #ifdef GUISTORM_NO_UTF
+                      std::string const &glyphs_to_load = ""
+                    #else
+                      std::u32string const &glyphs_to_load = U""
+                    #endif // GUISTORM_NO_UTF
+                    );
+    #endif // GUISTORM_NO_FREETYPE
+    void add_font(baked_font const &baked);
     void add_font(font *thisfont);
     void clear_fonts();
     #ifdef DEBUG_GUISTORM
@@ -8,8 +8,12 @@
 ///          GUISTORM_UNBIND - unbind shader and buffers after rendering
 ///          GUISTORM_NO_UTF - do not use utf8 and utf32 at all, limit all characters to ascii
 ///          GUISTORM_UNSAFEUTF - do not check UTF8 input for validity when iterating; this assumes you guarantee all strings are safe
-///          GUISTORM_LOAD_MISSING_GLYPHS - add any new characters we encounter dynamically to the texture atlas (can be costly at runtime)
+///          GUISTORM_LOAD_MISSING_GLYPHS - add any new characters we encounter dynamically to the texture atlas, one glyph at a time
 ///          GUISTORM_NO_TEXT - do not enable any text rendering components at all; removes all dependencies on freetype
+///          GUISTORM_NO_FREETYPE - only draw text in fonts baked ahead of time with the bake_font tool; removes the dependency on freetype but not freetype-gl's atlas
+///          GUISTORM_PICK_GRID - find the element under the cursor with a spatial grid instead of walking the tree; faster with many elements
+///          GUISTORM_GPU_TRANSITIONS - evaluate colour transitions in the vertex shader instead of blending every element's colours on the cpu each frame
+///          GUISTORM_INSTANCED_QUADS - draw every quad as an instance of one unit square, sending less than half the data per quad; needs ARB_instanced_arrays, else falls back to plain vertices
 ///          GUISTORM_ROUND_NEAREST_OUT - round screen positions and sizes to the nearest pixel when transforming to screen space
 ///          GUISTORM_ROUND_NEAREST_ALL - round all element screen positions and sizes to the nearest pixel at all stages
 ///            GUISTORM_ROUND_NEARBYINT - when rounding use std::nearbyint
@@ -25,6 +29,7 @@
 /// Convenience wrapper header to include all top level types
 
 #include "gui.h"
+#include "backend_null.h"
 
 #include "button.h"
 #include "graph_line.h"
@@ -40,5 +45,8 @@
 
 #include "colourgroup.h"
 #include "colourset.h"
+#include "palette.h"
+#include "baked_font.h"
 #include "font.h"
+#include "font_cache.h"
 #include "types.h"
@@ -4,6 +4,11 @@
 
 namespace guistorm {
   class gui;
+  class backend;
+  class backend_cache;
+  class backend_gl;
+  class backend_null;
+  class render_target;
 
   class button;
   class graph_line;
@@ -21,7 +26,10 @@ namespace guistorm {
 
   class colourgroup;
   class colourset;
+  class palette;
   #ifndef GUISTORM_NO_TEXT
+    struct baked_font;
     class font;
+    class font_cache;
   #endif // GUISTORM_NO_TEXT
 }
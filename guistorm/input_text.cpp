@@ -52,64 +52,6 @@ void input_text::on_release() {
   #endif // DEBUG_GUISTORM
 }
 
-void input_text::init_buffer() {
-  /// Generate the buffers for this object
-  glGenBuffers(1, &vbo_cursor);
-  glGenBuffers(1, &ibo_cursor);
-  base::init_buffer();
-}
-void input_text::destroy_buffer() {
-  /// Clean up the buffers in preparation for exit or context switch
-  glDeleteBuffers(1, &vbo_cursor);
-  glDeleteBuffers(1, &ibo_cursor);
-  vbo_cursor = 0;
-  ibo_cursor = 0;
-  numverts_cursor = 0;
-  base::destroy_buffer();
-}
-void input_text::setup_buffer() {
-  /// Create or update the buffer for this element
-  if(__builtin_expect(vbo_cursor == 0, 0)) {                                    // if the buffer hasn't been generated yet (unlikely)
-    init_buffer();
-  }
-
-  std::vector<vertex> vbodata;
-  coordtype const corner0(cursor_position);
-  coordtype const corner1(cursor_position + coordtype(2.0f, 10.0f));
-  // TODO: scale the cursor appropriately to the text
-  unsigned int ibo_offset = cast_if_required<GLuint>(vbodata.size());
-  vbodata.reserve(4);
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner0.x, corner0.y)));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner1.x, corner0.y)));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner1.x, corner1.y)));
-  vbodata.emplace_back(parent_gui->coord_transform(coordtype(corner0.x, corner1.y)));
-  std::vector<GLuint> ibodata {
-    ibo_offset + 0,
-    ibo_offset + 1,
-    ibo_offset + 2,
-    #ifdef GUISTORM_AVOIDQUADS
-      ibo_offset + 0,                                                           // doing this as indexed triangles instead of deprecated quads costs 50% more index entries
-      ibo_offset + 2,
-    #endif // GUISTORM_AVOIDQUADS
-    ibo_offset + 3
-  };
-  numverts_cursor = cast_if_required<GLuint>(ibodata.size());
-
-
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo_cursor);
-  glBufferData(GL_ARRAY_BUFFER,         vbodata.size() * sizeof(vertex), &vbodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-  #endif // GUISTORM_UNBIND
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_cursor);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, numverts_cursor * sizeof(GLuint), &ibodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  #endif // GUISTORM_UNBIND
-
-  base::setup_buffer();
-}
-
 void input_text::setup_label() {
   /// Wrapper around uploading the label that also appends a cursor update
   #ifndef GUISTORM_NO_TEXT
@@ -131,24 +73,12 @@ void input_text::render() {
   /// Draw the base element with a cursor overlaid if appropriate
   base::render();
 
-  if(!visible || !cursor_visible) {
+  if(!visible || culled || !cursor_visible) {
     return;
   }
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo_cursor);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_cursor);
-  glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-  glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-
-  glUniform4f(parent_gui->uniform_colour,
-              colours.current.content.r,
-              colours.current.content.g,
-              colours.current.content.b,
-              colours.current.content.a);
-  #ifdef GUISTORM_AVOIDQUADS
-    glDrawElements(GL_TRIANGLES, numverts_cursor, GL_UNSIGNED_INT, 0);
-  #else
-    glDrawElements(GL_QUADS, numverts_cursor, GL_UNSIGNED_INT, 0);
-  #endif // GUISTORM_AVOIDQUADS
+  // TODO: scale the cursor appropriately to the text
+  coordtype const corner0(get_absolute_position() + cursor_position);
+  parent_gui->current_batch->add_rect(corner0, corner0 + coordtype(2.0f, 10.0f), colours.get_paint_content()); // cursor
 }
 
 void input_text::selected_as_input() {
@@ -157,6 +87,7 @@ void input_text::selected_as_input() {
     std::cout << "GUIStorm: DEBUG: text input " << get_label() << " selected for global input" << std::endl;
   #endif // DEBUG_GUISTORM
   cursor_visible = true;
+  invalidate_appearance();
 }
 void input_text::deselected_as_input() {
   /// Notification function: called when this gets deselected as global input
@@ -164,6 +95,7 @@ void input_text::deselected_as_input() {
     std::cout << "GUIStorm: DEBUG: text input " << get_label() << " deselected for global input" << std::endl;
   #endif // DEBUG_GUISTORM
   cursor_visible = false;
+  invalidate_appearance();
 }
 
 unsigned int input_text::get_length_limit() const {
@@ -445,6 +377,7 @@ coordtype input_text::get_cursor_position() {
 void input_text::update_cursor() {
   /// Update the visible cursor position
   cursor_position = get_cursor_position();
+  invalidate_appearance();
   #ifdef DEBUG_GUISTORM
     #ifndef GUISTORM_SINGLETHREADED
       std::shared_lock lock(label_text_mutex);                                  // lock for reading (shared)
@@ -454,7 +387,6 @@ void input_text::update_cursor() {
       lock.unlock();
     #endif // GUISTORM_SINGLETHREADED
   #endif // DEBUG_GUISTORM
-  setup_buffer();
 }
 
 }
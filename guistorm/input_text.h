@@ -11,11 +11,7 @@ namespace guistorm {
 class input_text : public widget {
 private:
   unsigned int cursor = 0;                                                      // cursor position in the label string - which character it's before
-  coordtype cursor_position;                                                    // cached cursor rendering position
-
-  GLuint vbo_cursor      = 0;                                                   // vertex buffer for cursor in GL_QUADS format
-  GLuint ibo_cursor      = 0;                                                   // index buffer for cursor
-  GLuint numverts_cursor = 0;                                                   // number of vertices to render for the cursor
+  coordtype cursor_position;                                                    // cached cursor rendering position, relative to the origin
 
   unsigned int length_limit = 128;                                              // length limit for input
   bool multiline_allowed = false;                                               // whether to allow multiple line input
@@ -38,10 +34,7 @@ public:
 
   virtual void on_release() override final;
 
-  virtual void init_buffer() override final;
-  virtual void destroy_buffer() override final;
 protected:
-  virtual void setup_buffer() override final;
   virtual void setup_label() override final;
 public:
   virtual void render() override final;
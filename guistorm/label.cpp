@@ -14,7 +14,11 @@ label::label(container *newparent,
   /// Specific constructor
   focusable = false;
   #ifdef DEBUG_GUISTORM
-    colours.idle.outline.assign(1.0, 1.0, 0.0, 1.0);                            // draw a coloured outline for layout debugging purposes: yellow
+    palette debug_palette(get_palette());
+    debug_palette.idle.outline.assign(1.0, 1.0, 0.0, 1.0);                      // draw a coloured outline for layout debugging purposes: yellow
+    set_palette(palette::intern(debug_palette));
+  #else
+    draw_shape = false;                                                         // skip the unused outline and background
   #endif // DEBUG_GUISTORM
 }
 
@@ -26,40 +30,10 @@ base *label::get_picked(coordtype const &cursor_position [[maybe_unused]]) {
   /// Labels are never clickable
   return nullptr;
 }
-
-#ifndef DEBUG_GUISTORM
-  void label::init_buffer() {
-    /// Generate the buffers for this object
-    // skip initialising unused outline buffers
-    glGenBuffers(1, &vbo_label);
-    glGenBuffers(1, &ibo_label);
-  }
-  void label::destroy_buffer() {
-    /// Clean up the buffers in preparation for exit or context switch
-    // skip destroying unused outline buffers
-    glDeleteBuffers(1, &vbo_label);
-    glDeleteBuffers(1, &ibo_label);
-    //if(label_font) {
-    //  label_font->unload();
-    //}
-    vbo_label = 0;
-    ibo_label = 0;
-    numverts_label = 0;
-    initialised = false;
-  }
-
-  void label::setup_buffer() {
-    /// Create or update the buffer for this element
-    if(__builtin_expect(vbo_label == 0, 0)) {                                   // if the buffer hasn't been generated yet (unlikely)
-      init_buffer();
-    }
-    numverts = 0;                                                               // mark the outline and fill buffer as unused
-
-    setup_label();                                                              // set up the label buffer
-
-    initialised = true;
-  }
-#endif // DEBUG_GUISTORM
+bool label::is_pick_target() const {
+  /// Labels are never clickable
+  return false;
+}
 
 }
 
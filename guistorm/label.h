@@ -8,7 +8,7 @@
 namespace guistorm {
 
 class label : public widget {
-  /// A cut-down widget that has only a text label, no drawable outline buffer
+  /// A cut-down widget that has only a text label, no drawn outline
 public:
   label(container *parent,
         colourset const &colours,
@@ -21,14 +21,7 @@ protected:
 
 public:
   base *get_picked(coordtype const &cursor_position) override final __attribute__((__const__));
-
-  #ifndef DEBUG_GUISTORM
-    void init_buffer() override final;
-  protected:
-    void destroy_buffer() override final;
-  public:
-    void setup_buffer() override final;
-  #endif
+  bool is_pick_target() const override final __attribute__((__const__));
 };
 
 }
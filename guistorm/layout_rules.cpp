@@ -8,7 +8,7 @@ namespace layout {
 
 void centre_horizontally(layout::targettype target) {
   /// Position this element centered horizontally to its parent
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   if(parent_base) {
     target.set_position_nodpiscale((parent_base->get_size_nodpiscale().x - target.get_size_nodpiscale().x) / 2.0f, target.get_position_nodpiscale().y);
   } else {
@@ -24,7 +24,7 @@ void centre_horizontally(layout::targettype target) {
 
 void centre_vertically(layout::targettype target) {
   /// Position this element centered vertically to its parent
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   if(parent_base) {
     target.set_position_nodpiscale(target.get_position_nodpiscale().x, (parent_base->get_size_nodpiscale().y - target.get_size_nodpiscale().y) / 2.0f);
   } else {
@@ -39,7 +39,7 @@ void centre_vertically(layout::targettype target) {
 }
 void centre(layout::targettype target) {
   /// Position this element centered on both axes to its parent
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   if(parent_base) {
     target.set_position_nodpiscale((parent_base->get_size_nodpiscale() - target.get_size_nodpiscale()) / 2.0f);
   } else {
@@ -62,7 +62,7 @@ void offset_bottom(layout::targettype target, coordcomponent distance) {
 }
 void offset_right(layout::targettype target, coordcomponent distance) {
   /// Position this element in from the right edge of the parent by the specified optional distance
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   if(parent_base) {
     target.set_position_nodpiscale((parent_base->get_size_nodpiscale().x - target.get_size_nodpiscale().x) - distance, target.get_position_nodpiscale().y);
   } else {
@@ -77,7 +77,7 @@ void offset_right(layout::targettype target, coordcomponent distance) {
 }
 void offset_top(layout::targettype target, coordcomponent distance) {
   /// Position this element in from the bottom top of the parent by the specified optional distance
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   if(parent_base) {
     target.set_position_nodpiscale(target.get_position_nodpiscale().x, (parent_base->get_size_nodpiscale().y - target.get_size_nodpiscale().y) - distance);
   } else {
@@ -93,7 +93,7 @@ void offset_top(layout::targettype target, coordcomponent distance) {
 
 void fit_horizontally(targettype target, coordcomponent margin) {
   /// Position and scale this element to take up the full width of its parent minus the specified optional margin
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   target.set_position_nodpiscale(margin, target.get_position_nodpiscale().y);
   if(parent_base) {
     target.set_size_nodpiscale(parent_base->get_size_nodpiscale().x - (margin * 2.0f), target.get_size_nodpiscale().y);
@@ -109,7 +109,7 @@ void fit_horizontally(targettype target, coordcomponent margin) {
 }
 void fit_vertically(targettype target, coordcomponent margin) {
   /// Position and scale this element to take up the full height of its parent minus the specified optional margin
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   target.set_position_nodpiscale(target.get_position_nodpiscale().x, margin);
   if(parent_base) {
     target.set_size_nodpiscale(target.get_size_nodpiscale().x, parent_base->get_size_nodpiscale().y - (margin * 2.0f));
@@ -125,7 +125,7 @@ void fit_vertically(targettype target, coordcomponent margin) {
 }
 void fit(targettype target, coordcomponent margin) {
   /// Position and scale this element to take up the full size of its parent minus the specified optional margin
-  base *parent_base = dynamic_cast<base*>(target.parent);
+  base const *parent_base = target.parent_base;
   target.set_position_nodpiscale(margin, margin);
   if(parent_base) {
     target.set_size_nodpiscale(parent_base->get_size_nodpiscale() - (margin * 2.0f));
@@ -14,10 +14,6 @@ public:
 protected:
   ~line();
 
-public:
-  void init_buffer() override final;
-  void destroy_buffer() override final;
-protected:
   void setup_buffer() override final;
 public:
   void render() override final;
@@ -1,4 +1,5 @@
 #include "lineshape.h"
+#include <algorithm>
 #include <iostream>
 #include "cast_if_required.h"
 #include "gui.h"
@@ -45,15 +46,24 @@ void lineshape::upload_shape(std::vector<std::pair<coordtype, coordtype>> const
       ibodata.emplace_back(thisindex);
     }
   }
-  numverts = cast_if_required<GLuint>(ibodata.size());
-
   vbodata.shrink_to_fit();
+  if(!vbodata.empty()) {                                                        // the lines can reach anywhere around our origin, regardless of our size
+    bounds_lower = vbodata.front().coords;
+    bounds_upper = vbodata.front().coords;
+    for(vertex const &v : vbodata) {
+      bounds_lower.x = std::min(bounds_lower.x, v.coords.x);
+      bounds_lower.y = std::min(bounds_lower.y, v.coords.y);
+      bounds_upper.x = std::max(bounds_upper.x, v.coords.x);
+      bounds_upper.y = std::max(bounds_upper.y, v.coords.y);
+    }
+    bounds_upper += coordtype(1.0f, 1.0f);                                      // lines are rasterised a pixel wide, so cover the far edge's pixels too
+  }
 
   #ifdef DEBUG_GUISTORM
     std::cout << "GUIStorm: Lineshape indexer: " << lines.size() * 2 << " input verts reduced to " << vbodata.size() << " (" << ((lines.size() * 2) - vbodata.size()) * 100 / (lines.size() * 2) << "% sharing)" << std::endl;
   #endif // DEBUG_GUISTORM
 
-  refresh();                                                                    // calculates the transform
+  refresh();
 }
 
 base *lineshape::get_picked(coordtype const &cursor_position) {
@@ -63,88 +73,27 @@ base *lineshape::get_picked(coordtype const &cursor_position) {
   }
   return base::get_picked(cursor_position);
 }
-
-void lineshape::init_buffer() {
-  /// Generate the buffers for this object
-  glGenBuffers(1, &vbo);
-  glGenBuffers(1, &ibo);
-  // skip initialising unused label buffers
-}
-void lineshape::destroy_buffer() {
-  /// Clean up the buffers in preparation for exit or context switch
-  glDeleteBuffers(1, &vbo);
-  glDeleteBuffers(1, &ibo);
-  // skip destroying unused label buffers
-  vbo = 0;
-  ibo = 0;
-  numverts = 0;
-  initialised = false;
+bool lineshape::is_pick_target() const {
+  /// The current cursor is never picked, so it can't obscure what it's pointing at
+  return parent_gui->cursor != this;
 }
 
 void lineshape::setup_buffer() {
-  /// Create or update the buffer for this element
-  if(__builtin_expect(vbo == 0, 0)) {                                           // if the buffer hasn't been generated yet (unlikely)
-    init_buffer();
-  }
-
-  coordtype const position_transformed(parent_gui->coord_transform(position));
-  vbodata_shifted = vbodata_transformed;                                        // reuse the already allocated vector here
-  for(vertex &v : vbodata_shifted) {
-    v.coords += position_transformed;
-  }
-  numverts = cast_if_required<GLuint>(ibodata.size());
-
-  #ifdef DEBUG_GUISTORM
-    std::cout << "GUIStorm: Lineshape: Uploading " << vbodata.size() << " " << sizeof(vertex) << "B verts, " << numverts << " indices to vbo ("
-              << (vbodata.size() * sizeof(vertex)) << "B, "
-              << (numverts * sizeof(GLuint)) << "B)" << std::endl;
-  #endif // DEBUG_GUISTORM
-
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-  glBufferData(GL_ARRAY_BUFFER,         vbodata_shifted.size() * sizeof(vertex), &vbodata_shifted[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ARRAY_BUFFER,         0);
-  #endif // GUISTORM_UNBIND
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, numverts               * sizeof(GLuint), &ibodata[0], GL_STATIC_DRAW);
-  #ifdef GUISTORM_UNBIND
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  #endif // GUISTORM_UNBIND
-
-  initialised = true;
-}
-
-void lineshape::refresh() {
-  /// Transform the coords to gui space
-  vbodata_transformed = vbodata;                                                // use the cached vector to avoid reallocations
-  coordtype const baseoffset(parent_gui->coord_transform(coordtype(0.0, 0.0)));
-  for(vertex &v : vbodata_transformed) {
-    v.coords = parent_gui->coord_transform(v.coords) - baseoffset;
-  }
-  setup_buffer();
+  /// Create or update the cached geometry for this element
+  // skip setting up the unused label, the shape itself is kept relative to the origin and shifted as it's drawn
 }
 
 void lineshape::render() {
-  /// Draw this element
+  /// Submit this element's geometry to the gui's batch renderer
   if(!visible) {
     return;
   }
-  if(__builtin_expect(!initialised, 0)) {                                       // if the buffer hasn't been initialised yet (unlikely)
-    setup_buffer();
+  coordtype const origin(get_absolute_position());
+  if(cull(origin + bounds_lower, origin + bounds_upper)) {
+    return;
   }
-  glBindBuffer(GL_ARRAY_BUFFER,         vbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glVertexAttribPointer(parent_gui->attrib_coords,    2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::coords)));
-  glVertexAttribPointer(parent_gui->attrib_texcoords, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<GLvoid*>(offsetof(vertex, vertex::texcoords)));
-
-  glUniform4f(parent_gui->uniform_colour,
-              colours.current.outline.r,
-              colours.current.outline.g,
-              colours.current.outline.b,
-              colours.current.outline.a);
-  glDrawElements(GL_LINES, numverts, GL_UNSIGNED_INT, 0);                       // outline
-
-  update();
+  track_damage(origin + bounds_lower, origin + bounds_upper);
+  parent_gui->current_batch->add_lines(vbodata, ibodata, origin, colours.get_paint_outline()); // outline
 }
 
 }
@@ -8,10 +8,10 @@ namespace guistorm {
 class lineshape : public base {
   /// An object comprised of a set of straight vector lines
 private:
-  std::vector<vertex> vbodata;                                                  // the VBO vertex data, positioned relative to origin ready for shift and upload
-  std::vector<vertex> vbodata_transformed;                                      // the cached VBO vertex data that's been transformed to gui space
-  std::vector<vertex> vbodata_shifted;                                          // the cached VBO vertex data that's been offset by the object's position, ready for upload
-  std::vector<GLuint> ibodata;                                                  // indices for the VBO
+  std::vector<vertex> vbodata;                                                  // the vertex data, positioned relative to origin ready to be shifted as it's drawn
+  std::vector<GLuint> ibodata;                                                  // pairs of indices into the vertex data, one pair per line
+  coordtype bounds_lower;                                                       // box around every line, relative to origin, to cull and track damage with
+  coordtype bounds_upper;
 
 public:
   lineshape(container *parent,
@@ -25,13 +25,11 @@ public:
   void upload_shape(std::vector<std::pair<coordtype, coordtype>> const &lines);
 
   base *get_picked(coordtype const &cursor_position) override final;
+  bool is_pick_target() const override final;
 
-  void init_buffer() override final;
-  void destroy_buffer() override final;
 protected:
   void setup_buffer() override final;
 public:
-  void refresh() override final;
   void render() override final;
 };
 
@@ -0,0 +1,106 @@
+#include "palette.h"
+
+namespace guistorm {
+
+std::vector<std::weak_ptr<palette const>> palette::interned;
+#ifndef GUISTORM_SINGLETHREADED
+  std::mutex palette::interned_mutex;
+#endif // GUISTORM_SINGLETHREADED
+
+palette::palette() {
+  /// Default constructor
+}
+
+palette::palette(colourgroup const &colour_idle,
+                 colourgroup const &colour_hover,
+                 colourgroup const &colour_focus,
+                 colourgroup const &colour_active)
+  : idle(colour_idle),
+    hover(colour_hover),
+    focus(colour_focus),
+    active(colour_active) {
+  /// Specific constructor
+}
+
+palette::~palette() {
+  /// Default destructor
+}
+
+void palette::assign(colourgroup const &new_idle,
+                     colourgroup const &new_hover,
+                     colourgroup const &new_focus,
+                     colourgroup const &new_active) {
+  /// Assign a new set of colourgroups to this palette
+  idle   = new_idle;
+  hover  = new_hover;
+  focus  = new_focus;
+  active = new_active;
+}
+
+colourgroup const &palette::get(statetype state) const {
+  /// Return the colourgroup for a given state
+  switch(state) {
+  case statetype::HOVER:
+    return hover;
+  case statetype::FOCUS:
+    return focus;
+  case statetype::ACTIVE:
+    return active;
+  case statetype::IDLE:
+  default:
+    return idle;
+  }
+}
+float palette::get_duration(statetype state) const {
+  /// Return how long a transition to a given state takes, in seconds
+  switch(state) {
+  case statetype::HOVER:
+    return duration_hover;
+  case statetype::FOCUS:
+    return duration_focus;
+  case statetype::ACTIVE:
+    return duration_active;
+  case statetype::IDLE:
+  default:
+    return duration_idle;
+  }
+}
+
+bool palette::operator==(palette const &other) const {
+  /// Compare all colours and timings
+  for(statetype state : {statetype::IDLE, statetype::HOVER, statetype::FOCUS, statetype::ACTIVE}) {
+    colourgroup const &ours   = get(state);
+    colourgroup const &theirs = other.get(state);
+    if(ours.background != theirs.background ||
+       ours.outline    != theirs.outline    ||
+       ours.content    != theirs.content    ||
+       get_duration(state) != other.get_duration(state)) {
+      return false;
+    }
+  }
+  return easing == other.easing;
+}
+
+std::shared_ptr<palette const> palette::intern(palette const &colours) {
+  /// Return a shared palette with these colours, reusing an existing one if there is one
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(interned_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  for(unsigned int i = 0; i != interned.size();) {
+    std::shared_ptr<palette const> existing(interned[i].lock());
+    if(!existing) {
+      interned[i] = interned.back();                                            // nothing uses this any more, so swap it out
+      interned.pop_back();
+      continue;
+    }
+    if(*existing == colours) {
+      return existing;
+    }
+    ++i;
+  }
+  std::shared_ptr<palette const> result(std::make_shared<palette const>(colours));
+  interned.emplace_back(result);
+  return result;
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#ifndef GUISTORM_SINGLETHREADED
+  #include <mutex>
+#endif // GUISTORM_SINGLETHREADED
+#include "colourgroup.h"
+
+namespace guistorm {
+
+class palette {
+  /// The colours an element takes in each state, and how it fades between them.
+  /// Elements refer to a palette rather than holding their own copy, so most of
+  /// a gui shares a handful of them.  Palettes built from colours are interned,
+  /// so identical ones are only stored once; a palette made directly with
+  /// std::make_shared acts as a theme, never merged with others: assign new
+  /// colours to it then call gui::restyle() to show them on every element
+  /// using it at once.
+public:
+  enum class statetype : char {                                                 // which colourgroup an element is transitioning towards
+    IDLE,
+    HOVER,
+    FOCUS,
+    ACTIVE
+  };
+
+  colourgroup idle;                                                             // default colours at idle
+  colourgroup hover;                                                            // mouseover colours
+  colourgroup focus;                                                            // focus colours (when an element is currently selected for input)
+  colourgroup active;                                                           // active colours (while mouse_pressed / when text is being entered)
+
+  // transition timing, in seconds
+  float duration_idle   = 0.8f;                                                 // how long to fade back to idle
+  float duration_hover  = 0.1f;                                                 // how long to fade to the hover colours
+  float duration_focus  = 0.4f;                                                 // how long to fade to the focus colours
+  float duration_active = 0.1f;                                                 // how long to fade to the active colours
+  easetype easing = easetype::EASE_OUT;                                         // shape of the transition curve
+
+private:
+  static std::vector<std::weak_ptr<palette const>> interned;                    // every interned palette still in use
+  #ifndef GUISTORM_SINGLETHREADED
+    static std::mutex interned_mutex;                                           // protects the above
+  #endif // GUISTORM_SINGLETHREADED
+
+public:
+  palette();
+  palette(colourgroup const &idle,
+          colourgroup const &hover,
+          colourgroup const &focus,
+          colourgroup const &active);
+  ~palette();
+
+  void assign(colourgroup const &new_idle,
+              colourgroup const &new_hover,
+              colourgroup const &new_focus,
+              colourgroup const &new_active);
+
+  colourgroup const &get(statetype state) const __attribute__((__pure__));
+  float get_duration(statetype state) const __attribute__((__pure__));
+
+  bool operator==(palette const &other) const __attribute__((__pure__));
+
+  static std::shared_ptr<palette const> intern(palette const &colours);
+};
+
+}
@@ -0,0 +1,208 @@
+#include "pick_grid.h"
+
+#ifdef GUISTORM_PICK_GRID
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "base.h"
+#include "gui.h"
+
+namespace guistorm {
+
+pick_grid::pick_grid(gui &this_parent_gui)
+  : parent_gui(this_parent_gui) {
+  /// Specific constructor
+}
+
+void pick_grid::invalidate(base *element) {
+  /// Queue an element's subtree for reindexing after it moved, resized or changed visibility
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(pick_grid_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  if(rebuild_needed || element->pick_membership.pending) {
+    return;                                                                     // already covered
+  }
+  element->pick_membership.pending = true;
+  pending.emplace_back(element);
+}
+void pick_grid::invalidate_all() {
+  /// Rebuild the whole grid before the next query, after elements were added or removed or the window resized
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(pick_grid_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  rebuild_needed = true;
+}
+void pick_grid::forget(base *element) {
+  /// Make sure nothing refers to an element that is being destroyed
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(pick_grid_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  if(element->pick_membership.pending) {
+    pending.erase(std::remove(pending.begin(), pending.end(), element), pending.end());
+  }
+  rebuild_needed = true;                                                        // stale entries are discarded by the rebuild before they can be returned
+}
+
+base *pick_grid::get_picked(coordtype const &cursor_position) {
+  /// Return the topmost pickable element under the cursor, if any
+  #ifndef GUISTORM_SINGLETHREADED
+    std::lock_guard lock(pick_grid_mutex);
+  #endif // GUISTORM_SINGLETHREADED
+  if(rebuild_needed || pending.size() > pending_limit) {
+    rebuild();
+  } else {
+    for(auto const &element : pending) {
+      element->pick_membership.pending = false;
+      reindex(element);
+    }
+    pending.clear();
+  }
+
+  base *picked_element = nullptr;
+  unsigned int picked_rank = 0;
+  for(auto const &this_entry : cells[(get_cell_y(cursor_position.y) * cells_x) + get_cell_x(cursor_position.x)]) {
+    if(picked_element && this_entry.rank < picked_rank) {
+      continue;                                                                 // already beneath something we've hit
+    }
+    ++parent_gui.stats.pick_nodes_visited;
+    if(cursor_position.x >= this_entry.corner0.x &&
+       cursor_position.y >= this_entry.corner0.y &&
+       cursor_position.x <= this_entry.corner1.x &&
+       cursor_position.y <= this_entry.corner1.y &&
+       this_entry.element->is_pick_target()) {                                  // checked here rather than when indexing, as it can change at any time
+      picked_element = this_entry.element;
+      picked_rank    = this_entry.rank;
+    }
+  }
+  return picked_element;
+}
+
+void pick_grid::rebuild() {
+  /// Re-rank and re-enter every element from scratch
+  cells_x = std::max(1u, static_cast<unsigned int>(std::ceil(parent_gui.windowsize.x / cell_size)));
+  cells_y = std::max(1u, static_cast<unsigned int>(std::ceil(parent_gui.windowsize.y / cell_size)));
+  cells.resize(cells_x * cells_y);
+  for(auto &this_cell : cells) {
+    this_cell.clear();                                                          // keep the allocations
+  }
+  for(auto const &element : pending) {
+    element->pick_membership.pending = false;
+  }
+  pending.clear();
+
+  next_rank = 0;
+  coordtype const clip0(std::numeric_limits<coordcomponent>::lowest(), std::numeric_limits<coordcomponent>::lowest());
+  coordtype const clip1(std::numeric_limits<coordcomponent>::max(),    std::numeric_limits<coordcomponent>::max());
+  for(auto const &element : parent_gui.elements) {
+    insert_tree(element, coordtype(0, 0), clip0, clip1, true, true);
+  }
+  rebuild_needed = false;
+}
+
+void pick_grid::reindex(base *element) {
+  /// Re-enter an element and its children with their existing ranks
+  erase_tree(element);
+  // find the clip region and visibility inherited from the element's ancestors
+  coordtype clip0(std::numeric_limits<coordcomponent>::lowest(), std::numeric_limits<coordcomponent>::lowest());
+  coordtype clip1(std::numeric_limits<coordcomponent>::max(),    std::numeric_limits<coordcomponent>::max());
+  bool parent_visible = true;
+  for(base const *ancestor = element->parent_base; ancestor; ancestor = ancestor->parent_base) {
+    parent_visible = parent_visible && ancestor->visible;
+    if(ancestor->clips_picking()) {
+      coordtype const ancestor_origin(ancestor->get_absolute_position());
+      clip0.x = std::max(clip0.x, ancestor_origin.x);
+      clip0.y = std::max(clip0.y, ancestor_origin.y);
+      clip1.x = std::min(clip1.x, ancestor_origin.x + ancestor->size.x);
+      clip1.y = std::min(clip1.y, ancestor_origin.y + ancestor->size.y);
+    }
+  }
+  insert_tree(element, element->get_absolute_position() - element->position, clip0, clip1, parent_visible, false);
+}
+
+void pick_grid::insert_tree(base *element,
+                            coordtype const &parent_origin,
+                            coordtype const &clip0,
+                            coordtype const &clip1,
+                            bool parent_visible,
+                            bool assign_rank) {
+  /// Enter an element and its children into every cell their clipped rects overlap
+  auto &membership = element->pick_membership;
+  if(assign_rank) {
+    membership.rank = next_rank++;                                              // pre-order, so children rank above their parent and later siblings above earlier ones
+  }
+  membership = {membership.rank, 1, 1, 0, 0, membership.pending};               // not entered anywhere unless we find otherwise
+  coordtype const origin(parent_origin + element->position);
+  coordtype const corner0(std::max(clip0.x, origin.x),
+                          std::max(clip0.y, origin.y));
+  coordtype const corner1(std::min(clip1.x, origin.x + element->size.x),
+                          std::min(clip1.y, origin.y + element->size.y));
+  bool const visible = parent_visible && element->visible;
+  bool const overlaps = corner0.x <= corner1.x && corner0.y <= corner1.y;
+  if(visible && overlaps) {
+    membership.cell_x0 = get_cell_x(corner0.x);
+    membership.cell_y0 = get_cell_y(corner0.y);
+    membership.cell_x1 = get_cell_x(corner1.x);
+    membership.cell_y1 = get_cell_y(corner1.y);
+    for(unsigned int y = membership.cell_y0; y <= membership.cell_y1; ++y) {
+      for(unsigned int x = membership.cell_x0; x <= membership.cell_x1; ++x) {
+        cells[(y * cells_x) + x].emplace_back(entry{element, membership.rank, corner0, corner1});
+      }
+    }
+  }
+  container *children = element->as_container();
+  if(!children) {
+    return;
+  }
+  for(auto const &child : children->elements) {
+    if(element->clips_picking()) {
+      insert_tree(child, origin, corner0, corner1, visible, assign_rank);       // a window's children can only be picked within it
+    } else {
+      insert_tree(child, origin, clip0,   clip1,   visible, assign_rank);
+    }
+  }
+}
+
+void pick_grid::erase_tree(base *element) {
+  /// Remove an element and its children from every cell they're entered in
+  auto &membership = element->pick_membership;
+  for(unsigned int y = membership.cell_y0; y <= membership.cell_y1; ++y) {
+    for(unsigned int x = membership.cell_x0; x <= membership.cell_x1; ++x) {
+      auto &this_cell = cells[(y * cells_x) + x];
+      this_cell.erase(std::remove_if(this_cell.begin(), this_cell.end(), [element](entry const &this_entry){return this_entry.element == element;}), this_cell.end());
+    }
+  }
+  membership = {membership.rank, 1, 1, 0, 0, membership.pending};
+  container *children = element->as_container();
+  if(!children) {
+    return;
+  }
+  for(auto const &child : children->elements) {
+    erase_tree(child);
+  }
+}
+
+unsigned int pick_grid::get_cell_x(coordcomponent x) const {
+  /// Return which grid column contains this coordinate, clamping anything outside the window to the edge
+  if(x <= 0) {
+    return 0;
+  }
+  if(x >= cells_x * cell_size) {
+    return cells_x - 1;
+  }
+  return static_cast<unsigned int>(x / cell_size);
+}
+unsigned int pick_grid::get_cell_y(coordcomponent y) const {
+  /// Return which grid row contains this coordinate, clamping anything outside the window to the edge
+  if(y <= 0) {
+    return 0;
+  }
+  if(y >= cells_y * cell_size) {
+    return cells_y - 1;
+  }
+  return static_cast<unsigned int>(y / cell_size);
+}
+
+}
+
+#endif // GUISTORM_PICK_GRID
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef GUISTORM_PICK_GRID
+
+#include <vector>
+#ifndef GUISTORM_SINGLETHREADED
+  #include <mutex>
+#endif // GUISTORM_SINGLETHREADED
+#include "types.h"
+
+namespace guistorm {
+
+class gui;                                                                      // forward declarations
+class base;
+
+class pick_grid {
+  /// Uniform grid over the absolute rects of every visible element, so finding
+  /// the element under the cursor only tests the handful of elements sharing
+  /// its cell instead of walking the whole tree.  Each element is entered with
+  /// its rect clipped by any windows containing it, and ranked in drawing
+  /// order, so the highest ranked hit is the same element a reverse traversal
+  /// of the tree would have returned first.
+  /// Moving, resizing, showing or hiding an element reindexes only its own
+  /// subtree; adding or removing elements rebuilds the grid, as that changes
+  /// the ranks.  All updates are deferred until the next query.
+public:
+  struct membership {
+    /// Per-element record of where it sits in the grid
+    unsigned int rank = 0;                                                      // position of the element in drawing order, higher is on top
+    unsigned int cell_x0 = 1;                                                   // range of cells the element is entered in, empty if x0 > x1
+    unsigned int cell_y0 = 1;
+    unsigned int cell_x1 = 0;
+    unsigned int cell_y1 = 0;
+    bool pending = false;                                                       // whether this element is already queued for reindexing
+  };
+
+  static coordcomponent constexpr cell_size = 64;                               // width and height of each grid cell in pixels
+  static unsigned int constexpr pending_limit = 64;                             // beyond this many queued subtrees, rebuilding outright is cheaper
+
+private:
+  struct entry {
+    base *element;
+    unsigned int rank;
+    coordtype corner0;                                                          // absolute rect after clipping by parent windows
+    coordtype corner1;
+  };
+
+  gui &parent_gui;                                                              // the gui whose elements we index
+
+  unsigned int cells_x = 0;                                                     // grid dimensions, covering the window
+  unsigned int cells_y = 0;
+  std::vector<std::vector<entry>> cells;                                        // entries overlapping each cell, row by row
+
+  std::vector<base*> pending;                                                   // subtree roots that have moved, resized or changed visibility since the last query
+  bool rebuild_needed = true;                                                   // whether the tree structure or window size has changed since the last query
+  unsigned int next_rank = 0;                                                   // rank counter while rebuilding
+  #ifndef GUISTORM_SINGLETHREADED
+    std::mutex pick_grid_mutex;                                                 // protects everything above
+  #endif // GUISTORM_SINGLETHREADED
+
+public:
+  pick_grid(gui &parent_gui);
+
+  void invalidate(base *element);
+  void invalidate_all();
+  void forget(base *element);
+
+  base *get_picked(coordtype const &cursor_position);
+
+private:
+  void rebuild();
+  void reindex(base *element);
+  void insert_tree(base *element, coordtype const &parent_origin, coordtype const &clip0, coordtype const &clip1, bool parent_visible, bool assign_rank);
+  void erase_tree(base *element);
+  unsigned int get_cell_x(coordcomponent x) const __attribute__((__pure__));
+  unsigned int get_cell_y(coordcomponent y) const __attribute__((__pure__));
+};
+
+}
+
+#endif // GUISTORM_PICK_GRID
@@ -8,8 +8,6 @@ namespace guistorm {
 class progressbar : public base {
   /// A horizontal bar the fill of which reaches across horizontally to part of its width
 private:
-  GLuint vbo_fill = 0;                                                          // vertex buffer for the fill, in format compatible with GL_TRIANGLE_FAN - we use the same IBO as base
-
   float value = 0.0;                                                            // the value of the progress bar, from 0 to scale (may be negative if scale is negative)
   float scale = 1.0;                                                            // the scale of the progress bar, that the value relates to (may be negative)
 public:
@@ -23,10 +21,8 @@ protected:
   virtual ~progressbar() override;
 
 public:
-  void init_buffer()    override final;
-  void destroy_buffer() override final;
-  void setup_buffer()   override final;
-  void render()         override final;
+  void setup_buffer() override final;
+  void render()       override final;
 
   void set_value(float new_value);
   float const &get_value() const __attribute__((__const__));
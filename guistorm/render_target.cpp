@@ -0,0 +1,88 @@
+#include "render_target.h"
+#include <iostream>
+#include "backend.h"
+
+namespace guistorm {
+
+render_target::render_target() {
+  /// Default constructor
+}
+
+render_target::~render_target() {
+  /// Default destructor
+}
+
+bool render_target::setup(backend &render_backend, GLsizei new_width, GLsizei new_height) {
+  /// Create the texture and framebuffer, or resize them, discarding anything drawn so far
+  /// The backend must support framebuffers, and the size must fit within its texture size limit
+  /// Returns false if the driver can't draw into a texture of this size, leaving nothing set up
+  if(framebuffer == 0) {
+    texture     = render_backend.gen_texture();
+    framebuffer = render_backend.gen_framebuffer();
+  }
+  render_backend.bind_texture(GL_TEXTURE_2D, texture);
+  render_backend.tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); // composited pixel for pixel
+  render_backend.tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  render_backend.tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+  render_backend.tex_parameter(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+  render_backend.tex_image_2d(GL_TEXTURE_2D, GL_RGBA8, new_width, new_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  render_backend.bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+  render_backend.framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture);
+  GLenum const status = render_backend.check_framebuffer_status(GL_FRAMEBUFFER);
+  render_backend.bind_framebuffer(GL_FRAMEBUFFER, 0);
+  if(status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cout << "GUIStorm: ERROR: " << __PRETTY_FUNCTION__ << ": framebuffer of " << new_width << "x" << new_height << " is incomplete, status " << status << std::endl;
+    destroy(render_backend);
+    return false;
+  }
+  width  = new_width;
+  height = new_height;
+  return true;
+}
+void render_target::destroy(backend &render_backend) {
+  /// Release the texture and framebuffer, in preparation for exit or context switch
+  if(framebuffer != 0) {
+    render_backend.delete_framebuffer(framebuffer);
+    render_backend.delete_texture(texture);
+    framebuffer = 0;
+    texture     = 0;
+  }
+  width  = 0;
+  height = 0;
+}
+
+GLuint render_target::get_texture() const {
+  /// Return the texture to composite
+  return texture;
+}
+GLsizei render_target::get_width() const {
+  return width;
+}
+GLsizei render_target::get_height() const {
+  return height;
+}
+
+void render_target::begin(backend &render_backend) {
+  /// Start drawing into the texture instead of wherever we were drawing before
+  /// That may be the application's own framebuffer rather than the screen, so it's noted to restore afterwards
+  render_backend.get_integerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+  render_backend.get_integerv(GL_VIEWPORT,            previous_viewport);
+  render_backend.get_integerv(GL_BLEND_SRC_RGB,       &previous_blend[0]);
+  render_backend.get_integerv(GL_BLEND_DST_RGB,       &previous_blend[1]);
+  render_backend.get_integerv(GL_BLEND_SRC_ALPHA,     &previous_blend[2]);
+  render_backend.get_integerv(GL_BLEND_DST_ALPHA,     &previous_blend[3]);
+  render_backend.bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+  render_backend.viewport(0, 0, width, height);
+  render_backend.blend_func_separate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // keep the alpha channel as coverage, which leaves the colour premultiplied
+}
+void render_target::end(backend &render_backend) {
+  /// Go back to drawing wherever we were before begin(), with the blending and viewport used there
+  render_backend.blend_func_separate(static_cast<GLenum>(previous_blend[0]),
+                                     static_cast<GLenum>(previous_blend[1]),
+                                     static_cast<GLenum>(previous_blend[2]),
+                                     static_cast<GLenum>(previous_blend[3]));
+  render_backend.bind_framebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previous_framebuffer));
+  render_backend.viewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+}
+
+}
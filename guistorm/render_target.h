@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace guistorm {
+
+class backend;                                                                  // forward declaration
+
+class render_target {
+  /// A texture that can be drawn into through a framebuffer object, to keep
+  /// part of the gui drawn between frames, such as a cached window or the gui's
+  /// layer.  Colour is left premultiplied by alpha while drawing into it, which
+  /// the shader undoes when the texture is composited.
+  GLuint texture     = 0;
+  GLuint framebuffer = 0;
+  GLsizei width  = 0;                                                           // size of the texture in pixels
+  GLsizei height = 0;
+
+  GLint previous_framebuffer = 0;                                               // what was being drawn into when we began, to go back to at the end
+  GLint previous_viewport[4] = {0, 0, 0, 0};
+  GLint previous_blend[4]    = {GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA}; // source and destination, rgb then alpha
+
+public:
+  render_target();
+  ~render_target();
+
+  bool setup(backend &render_backend, GLsizei new_width, GLsizei new_height);
+  void destroy(backend &render_backend);
+
+  GLuint get_texture() const __attribute__((__pure__));
+  GLsizei get_width()  const __attribute__((__pure__));
+  GLsizei get_height() const __attribute__((__pure__));
+
+  void begin(backend &render_backend);
+  void end(  backend &render_backend);
+};
+
+}
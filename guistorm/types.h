@@ -28,4 +28,42 @@ enum class aligntype : char {
   TOP_RIGHT
 };
 
+enum class easetype : char {                                                    // how transitions progress over their duration - the order is shared with the shader
+  LINEAR,
+  EASE_IN,
+  EASE_OUT,
+  EASE_IN_OUT
+};
+
+#ifdef GUISTORM_GPU_TRANSITIONS
+  struct paint {
+    /// A colour transition for the shader to evaluate against the current time, so fading needs no cpu work per frame
+    colourtype colour;                                                          // colour at the start of the transition
+    colourtype colour_target;                                                   // colour at the end of the transition
+    vec4<GLfloat> transition;                                                   // start time in seconds, rate (1 / duration, or 0 for none), easing, unused
+
+    paint(colourtype const &new_colour = colourtype(1.0, 1.0, 1.0, 1.0))
+      : colour(new_colour),
+        colour_target(new_colour),
+        transition(0.0f, 0.0f, 0.0f, 0.0f) {
+      /// Constant colour constructor
+    }
+    paint(colourtype const &new_colour,
+          colourtype const &new_colour_target,
+          GLfloat start_time,
+          GLfloat duration,
+          easetype easing)
+      : colour(new_colour),
+        colour_target(new_colour_target),
+        transition(start_time, duration > 0.0f ? 1.0f / duration : 0.0f, static_cast<GLfloat>(easing), 0.0f) {
+      /// Transition constructor
+    }
+    bool is_transparent() const {
+      return colour.a == 0.0f && colour_target.a == 0.0f;
+    }
+  };
+#else
+  using paint = colourtype;                                                     // without gpu transitions we just draw with the current colour
+#endif // GUISTORM_GPU_TRANSITIONS
+
 }
@@ -1,4 +1,6 @@
 #include "window.h"
+#include <cmath>
+#include <iostream>
 #include "gui.h"
 
 namespace guistorm {
@@ -15,6 +17,7 @@ window::window(container *this_parent,
 
 window::~window() {
   /// Default destructor
+  destroy_render_cache();
 }
 
 void window::add_to_gui(base *element) {
@@ -41,6 +44,22 @@ base *window::get_picked(coordtype const &cursor_position) {
     }
   }
 }
+bool window::is_pick_target() const {
+  /// Windows are only picked themselves if they capture clicks
+  return capture_click;
+}
+bool window::clips_picking() const {
+  /// Children can only be picked within the window
+  return true;
+}
+container *window::as_container() {
+  /// Return this window's children
+  return this;
+}
+base *window::as_base() {
+  /// Return this window as the parent element of its children
+  return this;
+}
 
 coordtype const window::get_absolute_position() const {
   /// Return the absolute screen coords of the origin of this element
@@ -234,9 +253,116 @@ void window::shrink_to_labels(std::vector<base*>::const_iterator first [[maybe_u
 }
 #endif // GUISTORM_NO_TEXT
 
+void window::set_clip_children(bool new_clip_children) {
+  /// Choose whether to clip our contents to the window as they're drawn, as they already are for picking
+  /// Whole subtrees of a clipping window are skipped, without updating or rebuilding them, while it's out of sight,
+  /// so content scrolled out of a clipping panel costs nothing.  Render cached windows always clip their contents
+  if(clip_children == new_clip_children) {
+    return;
+  }
+  damage_drawn();                                                               // anything hanging outside us may disappear
+  clip_children = new_clip_children;
+  invalidate_appearance();
+}
+bool window::is_clipping_children() const {
+  /// Return whether our contents are clipped to the window
+  return clip_children || render_cached;
+}
+
+void window::set_render_cached(bool new_render_cached) {
+  /// Choose whether to draw this window and its contents into a texture, and reuse that until something in it changes
+  /// Suits windows that stay the same for many frames, such as menus and side panels; contents outside the window are
+  /// clipped to it.  Changes to a shared palette aren't seen until gui::restyle() is called
+  if(render_cached == new_render_cached) {
+    return;
+  }
+  render_cached = new_render_cached;
+  if(!render_cached) {
+    destroy_render_cache();
+  }
+  invalidate_render_cache();
+}
+bool window::is_render_cached() const {
+  /// Return whether this window is drawn through a cached texture
+  return render_cached;
+}
+void window::damage_drawn() {
+  /// Add wherever we and our contents were last drawn to the gui's damage region, as we won't be drawn there again
+  base::damage_drawn();
+  for(auto &element : elements) {
+    element->damage_drawn();
+  }
+}
+void window::invalidate_render_cache() {
+  /// Redraw our texture before it's next composited, as well as those of any cached windows we're in
+  render_cache_dirty = true;
+  base::invalidate_render_cache();
+}
+void window::restyle() {
+  /// Redraw our texture after a shared palette changes, as it holds our contents in their old colours
+  render_cache_dirty = true;
+  for(auto &element : elements) {
+    element->restyle();
+  }
+}
+void window::hold_render_cache(float until) {
+  /// Redraw our texture every frame until the given gui time, as well as those of any cached windows we're in
+  render_cache_dirty = true;
+  render_cache_hold_until = std::max(render_cache_hold_until, until);
+  base::hold_render_cache(until);
+}
+
+bool window::setup_render_cache() {
+  /// Make sure our texture exists and covers the window
+  /// Returns false if we can't be cached, in which case we're drawn directly as usual
+  backend &render_backend = *parent_gui->render_backend;
+  GLsizei const width  = static_cast<GLsizei>(std::ceil(size.x));
+  GLsizei const height = static_cast<GLsizei>(std::ceil(size.y));
+  if(width == render_cache_target.get_width() && height == render_cache_target.get_height()) {
+    return true;                                                                // already set up
+  }
+  if(!render_backend.has_framebuffers() || width <= 0 || height <= 0 || width > render_backend.get_max_texture_size() || height > render_backend.get_max_texture_size()) {
+    return false;
+  }
+  if(!render_cache_target.setup(render_backend, width, height)) {
+    std::cout << "GUIStorm: ERROR: " << __PRETTY_FUNCTION__ << ": cannot draw into a texture for a " << width << "x" << height << " window, drawing it uncached" << std::endl;
+    render_cached = false;
+    destroy_render_cache();
+    return false;
+  }
+  render_cache_dirty = true;                                                    // the new texture is empty
+  return true;
+}
+void window::destroy_render_cache() {
+  /// Release our texture and batch, to be recreated if needed
+  if(render_cache_target.get_texture() != 0) {
+    render_cache_target.destroy(*parent_gui->render_backend);
+  }
+  if(render_cache_batch) {
+    render_cache_batch->destroy_buffer();
+    render_cache_batch.reset();
+  }
+  render_cache_dirty = true;
+}
+
+void window::render_cache(GLuint texture) {
+  /// Draw the subtree collected by render() into our texture, ready for the gui's batch to composite
+  /// Called by the gui once its shader is bound, before it draws the rest of the frame
+  backend &render_backend = *parent_gui->render_backend;
+  coordtype const origin(get_absolute_position());
+  GLfloat const scale_x = 2.0f / static_cast<GLfloat>(render_cache_target.get_width());
+  GLfloat const scale_y = 2.0f / static_cast<GLfloat>(render_cache_target.get_height());
+  render_cache_target.begin(render_backend);
+  render_backend.clear_colour_buffer(0.0f, 0.0f, 0.0f, 0.0f);
+  render_backend.uniform4f(parent_gui->uniform_projection, scale_x, scale_y, -1.0f - (origin.x * scale_x), -1.0f - (origin.y * scale_y)); // map the window rather than the screen onto the texture
+  render_cache_batch->render(texture);
+  render_cache_target.end(render_backend);
+}
+
 void window::destroy_buffer() {
   base::destroy_buffer();
   container::destroy_buffer();
+  destroy_render_cache();
 }
 
 void window::update_layout() {
@@ -251,13 +377,67 @@ void window::refresh() {
   container::refresh();
 }
 
+void window::update_subtree() {
+  /// Update this element and all child elements without drawing them
+  if(!visible) {
+    return;
+  }
+  if(culled && is_clipping_children()) {
+    return;                                                                     // nothing of ours can be seen or picked
+  }
+  if(!culled) {
+    update();
+  }
+  for(auto &element : elements) {
+    element->update_subtree();
+  }
+}
+
 void window::render() {
-  /// Draw this element and all child elements
+  /// Draw this element and all child elements - or if render cached, the texture they were last drawn into
   if(!visible) {
     return;
   }
-  base::render();
-  container::render();
+  if(!render_cached || !setup_render_cache()) {
+    base::render();
+    if(!clip_children) {
+      container::render();                                                      // our contents may reach outside us, so are each culled on their own
+      return;
+    }
+    if(culled) {
+      return;                                                                   // none of our contents can be seen
+    }
+    batch &render_batch = *parent_gui->current_batch;
+    coordtype const clip_outside0(render_batch.get_clip_corner0());
+    coordtype const clip_outside1(render_batch.get_clip_corner1());
+    coordtype const origin(get_absolute_position());
+    render_batch.intersect_clip(origin, origin + size);
+    container::render();
+    render_batch.set_clip(clip_outside0, clip_outside1);                        // back to whatever clips us
+    return;
+  }
+  if(cull(get_absolute_position())) {
+    return;                                                                     // not even our texture can be seen, so leave it as it is
+  }
+  if(render_cache_dirty) {
+    render_cache_dirty = parent_gui->get_time() < render_cache_hold_until;      // cleared first, so anything changing while we collect is caught next frame - and kept while transitions run, to redraw once more after they end
+    if(!render_cache_batch) {
+      render_cache_batch = std::make_unique<batch>(*parent_gui);
+    }
+    render_cache_batch->clear();
+    render_cache_batch->set_clip(get_absolute_position(), get_absolute_position() + size); // only what's inside the window reaches the texture
+    batch *const batch_outside = parent_gui->current_batch;
+    parent_gui->current_batch = render_cache_batch.get();                       // collect our subtree into our own batch instead
+    base::render();
+    container::render();
+    parent_gui->current_batch = batch_outside;
+    parent_gui->render_cache_pending.emplace_back(this);                        // after any cached windows inside us, which have to be drawn first
+  } else {
+    track_damage(get_absolute_position());                                      // our contents aren't drawn, but we still may have moved
+  }
+  coordtype const origin(get_absolute_position());
+  coordtype const corner(origin + coordtype(static_cast<coordcomponent>(render_cache_target.get_width()), static_cast<coordcomponent>(render_cache_target.get_height())));
+  parent_gui->current_batch->add_texture(origin, corner, render_cache_target.get_texture(), paint(colourtype(1.0f, 1.0f, 1.0f, 1.0f)));
 }
 
 }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include "base.h"
 #include "container.h"
+#include "render_target.h"
 
 namespace guistorm {
 
@@ -9,6 +12,17 @@ class window : public base, public container {
 public:
   bool capture_click = true;
 
+private:
+  bool clip_children = false;                                                   // whether our contents are only drawn within the window, letting us skip them all once we're out of sight
+
+  // render caching
+  bool render_cached = false;                                                   // whether to draw our subtree into a texture, and only composite that while nothing changes
+  std::atomic_bool render_cache_dirty{true};                                    // whether the texture needs redrawing before it's next composited
+  float render_cache_hold_until = 0.0f;                                         // gui time to keep redrawing every frame until, while colour transitions are running
+  std::unique_ptr<batch> render_cache_batch;                                    // our subtree's geometry, collected when the texture is being redrawn
+  render_target render_cache_target;                                            // the texture our subtree is drawn into, covering the window
+
+public:
   window(container *parent,
          colourset const &colours,
          std::string const &label = std::string(),
@@ -22,6 +36,10 @@ public:
   void add_to_gui(base *element) override final;
 
   base *get_picked(coordtype const &cursor_position) override;
+  bool is_pick_target() const override;
+  bool clips_picking() const override __attribute__((__const__));
+  container *as_container() override final __attribute__((__const__));
+  base *as_base() override final __attribute__((__const__));
   coordtype const get_absolute_position() const override final;
 
   // layout control
@@ -45,11 +63,29 @@ public:
     void shrink_to_labels( std::vector<base*>::const_iterator first, std::vector<base*>::const_iterator last);
   #endif // GUISTORM_NO_TEXT
 
+  // clipping
+  void set_clip_children(bool new_clip_children);
+  bool is_clipping_children() const override final __attribute__((__pure__));
+
+  // render caching
+  void set_render_cached(bool new_render_cached);
+  bool is_render_cached() const __attribute__((__pure__));
+  void damage_drawn() override final;
+  void invalidate_render_cache() override final;
+  void restyle() override final;
+  void hold_render_cache(float until) override final;
+private:
+  bool setup_render_cache();
+  void destroy_render_cache();
+public:
+  void render_cache(GLuint texture);
+
   void destroy_buffer() override;
 
   void update_layout() override final;
   void refresh() override final;
 
+  void update_subtree() override final;
   void render() override;
 };
 
@@ -0,0 +1,70 @@
+/// Bakes a font into a header of constant data for guistorm::gui::add_font, so
+/// fixed fonts load at startup without rasterising anything, and builds with
+/// GUISTORM_NO_FREETYPE can still draw text.  Build against guistorm with
+/// freetype, then run as part of the build wherever the font or size changes:
+///
+///   bake_font <font file> <size in points> <dpi> <identifier> [characters] > header.h
+///
+/// The characters default to those every guistorm font loads; give them as
+/// utf8, starting with a space.  The header defines <identifier>, a
+/// guistorm::baked_font, along with the arrays it points to.  Any log output
+/// goes to stderr, so only the header itself is written to stdout.
+
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <string>
+#include "utf8/utf8.h"
+#include "guistorm/guistorm.h"
+
+int main(int argc, char *argv[]) {
+  if(argc < 5 || argc > 6) {
+    std::cerr << "usage: " << argv[0] << " <font file> <size in points> <dpi> <identifier> [characters] > header.h" << std::endl;
+    return 1;
+  }
+  std::ifstream file(argv[1], std::ios::binary);
+  if(!file) {
+    std::cerr << "bake_font: cannot read " << argv[1] << std::endl;
+    return 1;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string const font_data(buffer.str());
+  float const font_size = std::stof(argv[2]);
+  float const dpi       = std::stof(argv[3]);
+  std::string const identifier(argv[4]);
+  #ifdef GUISTORM_NO_UTF
+    std::string charcodes;
+    if(argc == 6) {
+      charcodes = argv[5];
+    }
+  #else
+    std::u32string charcodes;
+    if(argc == 6) {
+      std::string const characters(argv[5]);
+      for(auto it = characters.begin(); it != characters.end();) {
+        charcodes += utf8::next(it, characters.end());
+      }
+    }
+  #endif // GUISTORM_NO_UTF
+
+  std::streambuf *const header_buffer = std::cout.rdbuf(std::cerr.rdbuf());     // guistorm logs to std::cout, so send that to stderr to keep it out of the header
+  std::ostringstream header;
+  header.imbue(std::locale::classic());                                         // C++ literals need a decimal point, whatever the locale
+  {
+    guistorm::backend_null render_backend;                                      // nothing is drawn, so no context is needed
+    guistorm::gui baking_gui;
+    baking_gui.set_backend(render_backend);
+    baking_gui.set_dpi(dpi);
+    baking_gui.add_font(identifier, font_data, font_size, charcodes);
+    if(!baking_gui.fonts.back()->bake(header, identifier)) {
+      std::cerr << "bake_font: failed to bake " << argv[1] << " at size " << font_size << std::endl;
+      std::cout.rdbuf(header_buffer);
+      return 1;
+    }
+  }
+  std::cout.rdbuf(header_buffer);
+  std::cout << header.str();                                                    // only written once complete, so a failure leaves no partial header
+  return 0;
+}